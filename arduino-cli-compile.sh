@@ -1 +1,2 @@
-arduino-cli compile --fqbn esp32:esp32:esp32doit-devkit-v1 src --build-path cli-build/
+arduino-cli compile --fqbn esp32:esp32:esp32doit-devkit-v1 src --build-path cli-build/ --build-property "compiler.cpp.extra_flags=-fno-jump-tables -fno-tree-switch-conversion" &&
+python3 tools/iram_check.py --elf cli-build/src.ino.elf --map cli-build/src.ino.map cli-build/sketch/*.o
@@ -1,37 +1,148 @@
 #include <Arduino.h>
 #include "alarm_tone.h"
+#include "config_bundle.h"
 
-#define TONE_TIME 250 /* ms */
-#define TONE_SPACING 100 /* ms */
+#if ALARM_AUDIO_PCM
+
+#include "driver/i2s.h"
+#include "esp_timer.h"
+#include "sample_bank.h"
+
+#define AUDIO_I2S_PORT I2S_NUM_0
+
+AlarmTone::AlarmTone()
+: _playing(false)
+, _task(nullptr)
+, _buffers(0)
+, _total_us(0)
+, _max_us(0) {
+}
+
+void AlarmTone::init(uint8_t pin) {
+  _pin = pin; // 25 (DAC channel 1) or 26 (DAC channel 2)
+
+  i2s_config_t config = {};
+  config.mode = (i2s_mode_t)(I2S_MODE_MASTER | I2S_MODE_TX | I2S_MODE_DAC_BUILT_IN);
+  config.sample_rate = AUDIO_SAMPLE_RATE;
+  config.bits_per_sample = I2S_BITS_PER_SAMPLE_16BIT;
+  config.channel_format = I2S_CHANNEL_FMT_RIGHT_LEFT; // The built-in DAC plays both channels, each sample is written twice
+  config.communication_format = I2S_COMM_FORMAT_STAND_MSB;
+  config.dma_buf_count = 2; // Double buffering: one buffer plays while the other one is refilled
+  config.dma_buf_len = AUDIO_BUFFER_SAMPLES;
+  i2s_driver_install(AUDIO_I2S_PORT, &config, 0, NULL);
+  i2s_set_pin(AUDIO_I2S_PORT, NULL);
+  i2s_set_dac_mode(_pin == 26 ? I2S_DAC_CHANNEL_LEFT_EN : I2S_DAC_CHANNEL_RIGHT_EN);
+  i2s_zero_dma_buffer(AUDIO_I2S_PORT);
+
+  xTaskCreate(audioTask, "audio", 4096, this, configMAX_PRIORITIES - 2, &_task);
+}
+
+void IRAM_ATTR AlarmTone::stop() {
+  _playing = false; // The audio task silences the DAC after the buffer it is rendering
+}
+
+// Audio task: sleeps until the alarm rings, then renders one buffer at a time. `i2s_write()` blocks
+// until a DMA buffer is free, so the task runs once per buffer period (16 ms).
+void AlarmTone::stream() {
+  static int16_t mix[AUDIO_BUFFER_SAMPLES];
+  static uint16_t frames[AUDIO_BUFFER_SAMPLES * 2];
+
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+    _synth.start(SAMPLES, config_bundle.melody(), config_bundle.melody_length()); // Read in place from the bundle
+    _buffers = _total_us = _max_us = 0;
+
+    while (_playing) {
+      int64_t start = esp_timer_get_time();
+      _synth.render(mix, AUDIO_BUFFER_SAMPLES);
+      for (int i = 0; i < AUDIO_BUFFER_SAMPLES; i++) {
+        uint16_t dac = (uint16_t)(mix[i] + 0x8000) & 0xFF00; // The DAC takes the upper 8 bits, unsigned
+        frames[2 * i] = dac;
+        frames[2 * i + 1] = dac;
+      }
+      uint32_t cost = esp_timer_get_time() - start;
+      _buffers++;
+      _total_us += cost;
+      _max_us = cost > _max_us ? cost : _max_us;
+
+      size_t written;
+      i2s_write(AUDIO_I2S_PORT, frames, sizeof(frames), &written, portMAX_DELAY);
+    }
 
-static const uint16_t TONES[] = {
-  800,
-  800,
-};
-const uint16_t NUM_TONES = sizeof(TONES) / sizeof(TONES[0]);
+    _synth.stop();
+    i2s_zero_dma_buffer(AUDIO_I2S_PORT);
+    if (_buffers) {
+      Serial.printf("[audio] %u buffers, render avg %u us, max %u us of %u us\n", (unsigned)_buffers,
+                    (unsigned)(_total_us / _buffers), (unsigned)_max_us,
+                    (unsigned)(1000000UL * AUDIO_BUFFER_SAMPLES / AUDIO_SAMPLE_RATE));
+    }
+  }
+}
+
+#else
+
+#define TONE_SPACING 100 /* ms */
 
+// The melody is the tones section of the configuration bundle (`config_bundle.h`).
 AlarmTone::AlarmTone()
 : _playing(false)
-, _tone_index(0)
-, _last_tone_time(0) {
+, _task(nullptr) {
 }
 
 void AlarmTone::init(uint8_t pin) {
   _pin = pin;
   pinMode(_pin, OUTPUT);
+  xTaskCreate(audioTask, "audio", 2048, this, configMAX_PRIORITIES - 2, &_task);
+}
+
+void IRAM_ATTR AlarmTone::stop() {
+  if (_playing.exchange(false)) {
+    wake(); // Silence the buzzer now, not after the tone being played
+  }
+}
+
+// Audio task: sleeps until the alarm rings, then plays the tones one after the other,
+// until `stop()` wakes it up.
+void AlarmTone::stream() {
+  for (;;) {
+    ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+
+    for (uint8_t i = 0; _playing; i = (i + 1) % config_bundle.tone_count()) {
+      const BundleTone &note = config_bundle.tones()[i];
+      if (note.hz) { // 0 Hz is a rest
+        tone(_pin, note.hz, note.ms);
+      }
+      ulTaskNotifyTake(pdTRUE, pdMS_TO_TICKS(note.ms + TONE_SPACING));
+    }
+    noTone(_pin);
+  }
+}
+
+#endif
+
+// Called on every refresh while the alarm rings, possibly from the timer interrupt: only wakes the audio task up.
+void IRAM_ATTR AlarmTone::play() {
+  if (!_playing.exchange(true)) {
+    wake();
+  }
+}
+
+// Whether the alarm plays, from the first `play()` until `stop()`.
+bool IRAM_ATTR AlarmTone::playing() const {
+  return _playing;
 }
 
-void AlarmTone::play() {
-  if (!_playing || _last_tone_time + TONE_TIME + TONE_SPACING < millis()) {
-    tone(_pin, TONES[_tone_index], TONE_TIME);
-    _tone_index = (_tone_index + 1) % NUM_TONES;
-    _last_tone_time = millis();
+// Wakes the audio task up, from the timer interrupt or a task.
+void IRAM_ATTR AlarmTone::wake() {
+  if (xPortInIsrContext()) {
+    BaseType_t woken = pdFALSE;
+    vTaskNotifyGiveFromISR(_task, &woken);
+    portYIELD_FROM_ISR(woken);
+  } else {
+    xTaskNotifyGive(_task);
   }
-  _playing = true;
 }
 
-void AlarmTone::stop() {
-  noTone(_pin);
-  _tone_index = 0;
-  _playing = false;
+void AlarmTone::audioTask(void *tone) {
+  ((AlarmTone *)tone)->stream();
 }
@@ -1,18 +1,48 @@
 #ifndef ALARM_TONE_H
 #define ALARM_TONE_H
 
+#include <Arduino.h>
+#include <atomic>
+
+/// @brief PCM alarm audio.
+///
+/// When set to 1, the alarm plays a wavetable and PCM sample melody (`audio_synth.h`) through the
+/// built-in 8-bit DAC, on GPIO 25 or 26, instead of square-wave beeps with `tone()`. The samples are
+/// streamed to the DAC by the I2S DMA from two buffers; an audio task refills each buffer while the
+/// other one plays, so the CPU only runs the synthesizer.
+/// Either way, `play()` and `stop()` may be called from the timer interrupt: they only wake up an
+/// audio task, which drives the DAC or `tone()` (neither is safe in an ISR, nor in IRAM).
+/// Override with a build flag, e.g. `-DALARM_AUDIO_PCM=1`
+#ifndef ALARM_AUDIO_PCM
+#define ALARM_AUDIO_PCM 0
+#endif
+
+#if ALARM_AUDIO_PCM
+#include "audio_synth.h"
+#endif
+
 class AlarmTone {
   public:
     AlarmTone();
     void init(uint8_t pin);
     void play();
     void stop();
+    bool playing() const;
 
   private:
     uint8_t _pin;
-    bool _playing;
-    uint8_t _tone_index;
-    unsigned long _last_tone_time;
+    std::atomic<bool> _playing;
+    TaskHandle_t _task;
+#if ALARM_AUDIO_PCM
+    AudioSynth _synth;
+    uint32_t _buffers;   // Buffers rendered since the alarm started ringing
+    uint32_t _total_us;  // Time spent rendering them
+    uint32_t _max_us;    // Longest render
+#endif
+
+    static void audioTask(void *tone);
+    void wake();
+    void stream();
 };
 
 #endif
@@ -0,0 +1,130 @@
+/// @file audio_synth.cpp
+/// Implementation of the AudioSynth class.
+///
+/// This file contains the implementation of the alarm synthesizer. See audio_synth.h.
+#include <cmath>
+#include "audio_synth.h"
+
+/// @brief Start playing a melody from the beginning. The melody loops until `stop()`.
+/// @param bank The sample bank. Must stay alive while playing.
+/// @param melody The notes. Must stay alive while playing.
+/// @param length Number of notes.
+void AudioSynth::start(const Sample *bank, const Note *melody, uint16_t length)
+{
+    stop();
+    this->bank = bank;
+    this->melody = melody;
+    melody_length = length;
+    next_note = 0;
+    note_samples = 0; // Play the first note right away
+}
+
+/// @brief Stop the melody and silence all voices.
+void AudioSynth::stop()
+{
+    melody = nullptr;
+    for (Voice &voice : voices)
+    {
+        voice.sample = nullptr;
+    }
+}
+
+/// @brief Render the next samples.
+///
+/// Splits the buffer at note boundaries, so notes start on the exact sample whatever the buffer size.
+/// @param out Output buffer, 16-bit signed mono at `AUDIO_SAMPLE_RATE`.
+/// @param count Number of samples.
+void AudioSynth::render(int16_t *out, size_t count)
+{
+    while (count)
+    {
+        if (melody && note_samples == 0)
+        {
+            const Note &note = melody[next_note];
+            note_on(note);
+            note_samples = (uint32_t)note.ms * AUDIO_SAMPLE_RATE / 1000;
+            next_note = (next_note + 1) % melody_length;
+        }
+        size_t run = count;
+        if (melody && note_samples < run)
+        {
+            run = note_samples;
+        }
+        mix(out, run);
+        if (melody)
+        {
+            note_samples -= run;
+        }
+        out += run;
+        count -= run;
+    }
+}
+
+/// @brief Start a note on the next voice, cutting the note it was playing.
+/// @param note The note. Rests don't start a voice.
+void AudioSynth::note_on(const Note &note)
+{
+    if (!note.key)
+    {
+        return;
+    }
+    Voice &voice = voices[next_voice];
+    next_voice = (next_voice + 1) % AUDIO_VOICES;
+    voice.sample = &bank[note.sample];
+    float hz = 440.0f * powf(2.0f, (note.key - 69) / 12.0f); // Only computed once per note
+    voice.increment = (uint32_t)(hz / voice.sample->root_hz * 65536.0f);
+    voice.phase = 0;
+    voice.gain = 256;
+}
+
+/// @brief Mix the active voices into the output buffer, with no note change.
+/// @param out Output buffer.
+/// @param count Number of samples.
+void AudioSynth::mix(int16_t *out, size_t count)
+{
+    for (size_t i = 0; i < count; i++)
+    {
+        if (decay_samples == 0) // Envelope step: the looped voices fade out, so overlapping notes don't pile up
+        {
+            decay_samples = AUDIO_DECAY_SAMPLES;
+            for (Voice &voice : voices)
+            {
+                if (voice.sample && voice.sample->loop_start < voice.sample->length)
+                {
+                    voice.gain -= voice.gain >> 4; // -0.56 dB per step
+                    if (voice.gain < 16)
+                    {
+                        voice.sample = nullptr;
+                    }
+                }
+            }
+        }
+        decay_samples--;
+
+        int32_t sum = 0;
+        for (Voice &voice : voices)
+        {
+            const Sample *sample = voice.sample;
+            if (!sample)
+            {
+                continue;
+            }
+            uint32_t index = voice.phase >> 16;
+            if (index >= sample->length)
+            {
+                if (sample->loop_start >= sample->length) // One-shot: the voice ends
+                {
+                    voice.sample = nullptr;
+                    continue;
+                }
+                uint32_t loop = sample->length - sample->loop_start;
+                index = sample->loop_start + (index - sample->loop_start) % loop;
+                voice.phase = index << 16 | (voice.phase & 0xFFFF);
+            }
+            sum += sample->data[index] * voice.gain; // Up to 127 * 256 per voice
+            voice.phase += voice.increment;
+        }
+        sum >>= 1; // Headroom for two full-scale voices, clip the rest
+        out[i] = sum > INT16_MAX ? INT16_MAX : sum < INT16_MIN ? INT16_MIN : sum;
+    }
+}
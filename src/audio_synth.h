@@ -0,0 +1,70 @@
+/// @file audio_synth.h
+/// Interfaces the AudioSynth class.
+///
+/// A small wavetable and PCM sample synthesizer for the alarm sound. It plays a melody from
+/// a read-only sample bank and mixes its voices into 16-bit mono buffers. It has no hardware
+/// dependencies: the firmware streams the buffers to the DAC (see alarm_tone.cpp), and
+/// `tools/render_wav.cpp` renders them to a WAV file on the host.
+#ifndef AUDIO_SYNTH_H
+#define AUDIO_SYNTH_H
+
+#include <cstdint>
+#include <cstddef>
+
+#define AUDIO_SAMPLE_RATE 16000   ///< Output sample rate, in Hz. The sample bank is stored at this rate.
+#define AUDIO_BUFFER_SAMPLES 256  ///< Samples per output buffer (16 ms)
+#define AUDIO_VOICES 4            ///< Voices mixed at the same time
+#define AUDIO_DECAY_SAMPLES 64    ///< Samples between envelope steps
+
+/// @brief An 8-bit signed sample in the sample bank.
+///
+/// A wavetable holds one period and loops from `loop_start = 0`. A PCM one-shot
+/// sample has `loop_start = length`, and its voice ends at the last sample.
+struct Sample
+{
+    const int8_t *data;  ///< Sample data, in flash
+    uint16_t length;     ///< Number of samples
+    uint16_t loop_start; ///< First sample of the loop, `length` for no loop
+    float root_hz;       ///< Pitch of the sample when played at `AUDIO_SAMPLE_RATE`
+};
+
+/// @brief A note of a melody.
+struct Note
+{
+    uint8_t key;         ///< MIDI key number (69 = A4, 440 Hz). 0 for a rest.
+    uint8_t sample;      ///< Index of the sample in the bank
+    uint16_t ms;         ///< Time until the next note, in milliseconds
+};
+
+/// @brief A playing sample, with its pitch and volume envelope.
+struct Voice
+{
+    const Sample *sample = nullptr; ///< `nullptr` when the voice is free
+    uint32_t phase = 0;             ///< Position in the sample, 16.16 fixed point
+    uint32_t increment = 0;         ///< Phase increment per output sample, 16.16 fixed point
+    uint16_t gain = 0;              ///< Volume, 0 to 256
+};
+
+class AudioSynth
+{
+public:
+    void start(const Sample *bank, const Note *melody, uint16_t length);
+    void stop();
+    bool playing() const { return melody != nullptr; }
+    void render(int16_t *out, size_t count);
+
+private:
+    Voice voices[AUDIO_VOICES];
+    const Sample *bank = nullptr;
+    const Note *melody = nullptr;  ///< `nullptr` when stopped
+    uint16_t melody_length = 0;
+    uint16_t next_note = 0;        ///< Index of the next note to play
+    uint32_t note_samples = 0;     ///< Samples until the next note
+    uint8_t next_voice = 0;        ///< Voice to use for the next note, round robin
+    uint8_t decay_samples = 0;     ///< Samples until the next envelope step
+
+    void note_on(const Note &note);
+    void mix(int16_t *out, size_t count);
+};
+
+#endif
@@ -0,0 +1,40 @@
+/// @file boot_profile.cpp
+/// Implementation of the BootProfile class.
+///
+/// This file contains the timing of the startup phases. See boot_profile.h.
+#include <Arduino.h>
+#include "boot_profile.h"
+#include "esp_timer.h"
+
+/// @brief End the current phase. The first phase starts with the application.
+/// @param phase Name of the phase. Must stay valid until `report()`, e.g. a string literal.
+void BootProfile::mark(const char *phase)
+{
+    if (count < BOOT_PHASES)
+    {
+        phases[count] = phase;
+        ends_us[count++] = esp_timer_get_time();
+    }
+}
+
+/// @brief End the phase that shows the first frame, and record the time to the first frame.
+void BootProfile::mark_first_frame()
+{
+    first_frame_us = esp_timer_get_time();
+    mark("first frame");
+}
+
+/// @brief Print the duration of each phase, and the time to the first frame.
+///
+/// Called at the end of `setup()`, so the printing isn't part of the profile.
+/// @param out Where to print, e.g. `Serial`.
+void BootProfile::report(Print &out)
+{
+    int64_t start_us = 0;
+    for (uint8_t i = 0; i < count; i++)
+    {
+        out.printf("[boot] %-12s %7u us\n", phases[i], (unsigned)(ends_us[i] - start_us));
+        start_us = ends_us[i];
+    }
+    out.printf("[boot] first frame at %u us, setup done at %u us\n", (unsigned)first_frame_us, (unsigned)start_us);
+}
@@ -0,0 +1,28 @@
+/// @file boot_profile.h
+/// Interfaces the BootProfile class.
+///
+/// Times the phases of `setup()`, from the start of the application (`esp_timer_get_time()`
+/// counts from there; the ROM and the bootloader before it aren't included), and reports
+/// them with the time to the first frame on the serial console.
+#ifndef BOOT_PROFILE_H
+#define BOOT_PROFILE_H
+
+#include <Arduino.h>
+
+#define BOOT_PHASES 12 ///< Most phases recorded
+
+class BootProfile
+{
+private:
+    const char *phases[BOOT_PHASES]; ///< Name of each phase
+    int64_t ends_us[BOOT_PHASES];    ///< End of each phase, in microseconds since the application started
+    int64_t first_frame_us = -1;     ///< Time the first frame was shown, or -1
+    uint8_t count = 0;               ///< Phases recorded
+
+public:
+    void mark(const char *phase);
+    void mark_first_frame();
+    void report(Print &out);
+};
+
+#endif
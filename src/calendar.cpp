@@ -0,0 +1,127 @@
+/// @file calendar.cpp
+/// Implementation of the civil date conversions and daylight saving time rules.
+///
+/// See calendar.h.
+#include "esp_attr.h"
+#include "calendar.h"
+
+/// @brief Built-in time zones, indexed by `TimeZoneId`. In DRAM, as `localize()` reads them from the timer ISR.
+DRAM_ATTR const TimeZone TIME_ZONES[] = {
+    {0, 0, {0, 0, 0, 0}, {0, 0, 0, 0}},         // TZ_UTC
+    {60, 60, {3, 5, 0, 2}, {10, 5, 0, 2}},      // TZ_CENTRAL_EU: last Sunday of March to last Sunday of October, 01:00 UTC
+    {-300, 60, {3, 2, 0, 2}, {11, 1, 0, 1}},    // TZ_US_EASTERN: second Sunday of March to first Sunday of November, 02:00 local
+    {120, 60, {4, 5, 5, 0}, {10, 5, 4, 23}},    // TZ_EGYPT: last Friday of April to the end of the last Thursday of October
+};
+
+/// @brief Days since 1970-01-01 of a civil date.
+/// @param year Year.
+/// @param month Month, 1 to 12.
+/// @param day Day of the month, 1 to 31.
+/// @return Days since 1970-01-01. Negative for earlier dates.
+int32_t IRAM_ATTR days_from_civil(int16_t year, uint8_t month, uint8_t day)
+{
+    int32_t y = year - (month <= 2);                                // The computational year starts in March
+    int32_t era = (y >= 0 ? y : y - 399) / 400;                     // 400-year era
+    uint32_t yoe = y - era * 400;                                   // Year of era [0, 399]
+    uint32_t doy = (153 * (month > 2 ? month - 3 : month + 9) + 2) / 5 + day - 1; // Day of the March-based year [0, 365]
+    uint32_t doe = yoe * 365 + yoe / 4 - yoe / 100 + doy;          // Day of era [0, 146096]
+    return era * 146097 + (int32_t)doe - 719468;                    // 719468 days from 0000-03-01 to 1970-01-01
+}
+
+/// @brief Civil date of a number of days since 1970-01-01. Inverse of `days_from_civil()`.
+/// @param days Days since 1970-01-01.
+/// @return The civil date.
+CivilDate IRAM_ATTR civil_from_days(int32_t days)
+{
+    days += 719468;
+    int32_t era = (days >= 0 ? days : days - 146096) / 146097;
+    uint32_t doe = days - era * 146097;                                 // Day of era [0, 146096]
+    uint32_t yoe = (doe - doe / 1460 + doe / 36524 - doe / 146096) / 365; // Year of era [0, 399]
+    uint32_t doy = doe - (365 * yoe + yoe / 4 - yoe / 100);            // Day of the March-based year [0, 365]
+    uint32_t mp = (5 * doy + 2) / 153;                                  // March-based month [0, 11]
+    uint8_t month = mp < 10 ? mp + 3 : mp - 9;
+    uint8_t day = doy - (153 * mp + 2) / 5 + 1;
+    return {(int16_t)(yoe + era * 400 + (month <= 2)), month, day};
+}
+
+/// @brief Day of the week of a number of days since 1970-01-01 (a Thursday).
+/// @param days Days since 1970-01-01.
+/// @return 0 = Sunday, 6 = Saturday.
+uint8_t IRAM_ATTR weekday_from_days(int32_t days)
+{
+    return days >= -4 ? (days + 4) % 7 : (days + 5) % 7 + 6;
+}
+
+/// @brief Division rounding towards negative infinity.
+/// @return @f$\lfloor a / b \rfloor@f$
+int32_t IRAM_ATTR floor_div(int64_t a, int32_t b)
+{
+    int64_t q = a / b;
+    return q - (a % b < 0);
+}
+
+/// @brief UTC time of a DST change in a given year.
+/// @param rule The DST change rule.
+/// @param year The year.
+/// @param offset_min Standard time offset from UTC, in minutes.
+/// @return Milliseconds since 1970-01-01 UTC.
+int64_t IRAM_ATTR dst_rule_utc_ms(const DstRule &rule, int16_t year, int16_t offset_min)
+{
+    int32_t day;
+    if (rule.week == 5) // Last weekday of the month: count back from the last day
+    {
+        int32_t last = rule.month == 12 ? days_from_civil(year + 1, 1, 1) - 1 : days_from_civil(year, rule.month + 1, 1) - 1;
+        day = last - (weekday_from_days(last) + 7 - rule.weekday) % 7;
+    }
+    else // n-th weekday of the month: count forward from the first day
+    {
+        int32_t first = days_from_civil(year, rule.month, 1);
+        day = first + (rule.weekday + 7 - weekday_from_days(first)) % 7 + (rule.week - 1) * 7;
+    }
+    return (int64_t)day * MS_PER_DAY + rule.hour * MS_PER_HOUR - offset_min * MS_PER_MIN;
+}
+
+/// @brief Offset from UTC of a time zone at a given time, including DST.
+///
+/// Computes the two DST changes of the current year only, so the cost is constant.
+/// Handles both hemispheres: DST starting before or after it ends in the calendar year.
+/// @param zone The time zone.
+/// @param epoch_ms Milliseconds since 1970-01-01 UTC.
+/// @param next_change_ms If not null, receives the UTC time of the next offset change (INT64_MAX if none).
+/// @return The offset from UTC, in milliseconds.
+int32_t IRAM_ATTR utc_offset_ms(const TimeZone &zone, int64_t epoch_ms, int64_t *next_change_ms)
+{
+    int32_t standard = zone.offset_min * MS_PER_MIN;
+    int64_t next = INT64_MAX;
+    bool dst = false;
+
+    if (zone.dst_shift_min)
+    {
+        int16_t year = civil_from_days(floor_div(epoch_ms + standard, MS_PER_DAY)).year;
+        int64_t start = dst_rule_utc_ms(zone.dst_start, year, zone.offset_min);
+        int64_t end = dst_rule_utc_ms(zone.dst_end, year, zone.offset_min);
+        bool north = start < end; // DST starts and ends in the same calendar year
+
+        if (epoch_ms < (north ? start : end)) // Before the first change of the year
+        {
+            dst = !north;
+            next = north ? start : end;
+        }
+        else if (epoch_ms < (north ? end : start)) // Between the two changes
+        {
+            dst = north;
+            next = north ? end : start;
+        }
+        else // After the second change: the next one is the first change of next year
+        {
+            dst = !north;
+            next = dst_rule_utc_ms(north ? zone.dst_start : zone.dst_end, year + 1, zone.offset_min);
+        }
+    }
+
+    if (next_change_ms)
+    {
+        *next_change_ms = next;
+    }
+    return standard + (dst ? zone.dst_shift_min * MS_PER_MIN : 0);
+}
@@ -0,0 +1,70 @@
+/// @file calendar.h
+/// Civil date conversions and daylight saving time rules.
+///
+/// All conversions are loop-free and run in constant time. Days are counted from 1970-01-01
+/// (the Unix epoch) in the proleptic Gregorian calendar. The algorithms are the `days_from_civil`
+/// and `civil_from_days` algorithms by Howard Hinnant:
+/// [chrono-Compatible Low-Level Date Algorithms](https://howardhinnant.github.io/date_algorithms.html)
+#ifndef CALENDAR_H
+#define CALENDAR_H
+
+#include <cstdint>
+
+#define MS_PER_DAY 86400000L ///< Milliseconds in a day
+#define MS_PER_HOUR 3600000L ///< Milliseconds in an hour
+#define MS_PER_MIN 60000L    ///< Milliseconds in a minute
+
+/// @brief A civil (year, month, day) date.
+struct CivilDate
+{
+    int16_t year;  ///< Year, e.g. 2024
+    uint8_t month; ///< Month, 1 to 12
+    uint8_t day;   ///< Day of the month, 1 to 31
+};
+
+/// @brief A daylight saving time change rule: "the n-th (or last) weekday of a month, at an hour".
+struct DstRule
+{
+    uint8_t month;   ///< Month, 1 to 12
+    uint8_t week;    ///< 1 to 4 for the n-th weekday of the month, 5 for the last one
+    uint8_t weekday; ///< 0 = Sunday, 6 = Saturday
+    uint8_t hour;    ///< Hour of the change, in local standard time
+};
+
+/// @brief A time zone: a standard offset from UTC and an optional DST rule pair.
+struct TimeZone
+{
+    int16_t offset_min;    ///< Standard time offset from UTC, in minutes
+    int16_t dst_shift_min; ///< Offset added while DST is in effect, in minutes. 0 for no DST.
+    DstRule dst_start;     ///< Start of DST
+    DstRule dst_end;       ///< End of DST
+};
+
+/// @brief Identifiers of the built-in time zones. Index into `TIME_ZONES`.
+enum TimeZoneId
+{
+    TZ_UTC = 0,        ///< UTC, no DST
+    TZ_CENTRAL_EU = 1, ///< Central Europe (CET/CEST)
+    TZ_US_EASTERN = 2, ///< US Eastern (EST/EDT)
+    TZ_EGYPT = 3,      ///< Egypt (EET/EEST)
+    TZ_COUNT           ///< Number of built-in time zones
+};
+
+extern const TimeZone TIME_ZONES[];
+
+/// @brief Day of the week bit masks, used for alarm recurrence. Bit n is weekday n (0 = Sunday).
+enum WeekdayMask
+{
+    EVERY_DAY = 0b1111111,
+    WEEKDAYS = 0b0111110, ///< Monday to Friday
+    WEEKENDS = 0b1000001, ///< Saturday and Sunday
+};
+
+int32_t days_from_civil(int16_t year, uint8_t month, uint8_t day);
+CivilDate civil_from_days(int32_t days);
+uint8_t weekday_from_days(int32_t days);
+int32_t floor_div(int64_t a, int32_t b);
+int64_t dst_rule_utc_ms(const DstRule &rule, int16_t year, int16_t offset_min);
+int32_t utc_offset_ms(const TimeZone &zone, int64_t epoch_ms, int64_t *next_change_ms);
+
+#endif
@@ -5,6 +5,9 @@
 #include <Arduino.h>
 #include "clock.h"
 #include "stdio.h"
+#include "esp_timer.h"
+#include "esp_sleep.h"
+#include "driver/timer.h"
 
 // Static function: Update time, show things on display
 //                  and check alarm trigger
@@ -12,19 +15,93 @@
 // {
 // }
 
+#if CLOCK_DUAL_CORE
+#define TICK_EVENT 0b01   ///< Timekeeping task notification bit: timer tick
+#define BUTTON_EVENT 0b10 ///< Timekeeping task notification bit: button press queued
+
+static TaskHandle_t timekeeping_task = NULL; ///< Task pinned to `TIMEKEEPING_CORE`
+static TaskHandle_t render_task = NULL;      ///< Task pinned to `RENDER_CORE`
+static TaskHandle_t console_task = NULL;     ///< Task pinned to `RENDER_CORE`
+
+static void timekeepingTask(void *clock) { ((Clock *)clock)->timekeeping_loop(); }
+static void renderTask(void *clock) { ((Clock *)clock)->render_loop(); }
+static void consoleTask(void *clock) { ((Clock *)clock)->console_loop(); }
+#endif
+
 /// @brief The interrupt service routine for the clock timer. This iterrupt is called every 0.5 seconds.
 ///
 /// An explanation of how to use timer interrupts can be found in
 /// [Arduino-ESP32 Timer API](https://docs.espressif.com/projects/arduino-esp32/en/latest/api/timer.html)
 /// @return void
-void ARDUINO_ISR_ATTR onTimer()
+void IRAM_ATTR onTimer()
 {
-    clk.update_time();
-    clk.check_alarm();
-    clk.show();
+#if CLOCK_DUAL_CORE
+    BaseType_t woken = pdFALSE;
+    xTaskNotifyFromISR(timekeeping_task, TICK_EVENT, eSetBits, &woken); // Defer the tick to the timekeeping task
+    portYIELD_FROM_ISR(woken);
+#else
+    clk.tick();
+#endif
 }
 //------------------------------------------------------------------------
 
+/// @brief Fill a frame with a label of the configuration bundle. The labels are already encoded.
+/// @param frame The frame to fill.
+/// @param id The label.
+static void IRAM_ATTR label(Frame &frame, LabelId id)
+{
+    const uint8_t *segments = config_bundle.label(id);
+    for (uint8_t i = 0; i < TM1637_DIGITS; i++)
+    {
+        frame.segments[i] = segments[i];
+    }
+}
+
+/// @brief Fill a digits array with a duration: SS:hh (seconds and hundredths) under a minute, MM:SS above,
+///        and h:mm (hours unpadded) from 100 minutes. 6-digit modules show MM:SS:hh, then h:mm:ss.
+///        Longer durations than `DURATION_MAX_US` stay at 99:59(:59).
+/// @param data The digits array to be encoded and sent to the display.
+/// @param us The duration, in microseconds.
+static void IRAM_ATTR duration(int8_t data[], int64_t us)
+{
+    uint32_t hundredths = (us < DURATION_MAX_US ? us : DURATION_MAX_US) / 10000;
+    uint32_t seconds = hundredths / 100;
+    uint32_t minutes = seconds / 60;
+    uint8_t pairs[4] = {(uint8_t)(minutes / 60), (uint8_t)(minutes % 60), (uint8_t)(seconds % 60), (uint8_t)(hundredths % 100)};
+    bool hours = minutes >= 100; // h mm ss hh, or mm ss hh under 100 minutes
+    if (!hours)
+    {
+        pairs[1] = minutes;
+    }
+#if TM1637_DIGITS == 6
+    const uint8_t *shown = hours ? pairs : pairs + 1;                           // h mm ss or MM SS hh
+#else
+    const uint8_t *shown = hours ? pairs : seconds < 60 ? pairs + 2 : pairs + 1; // h mm, SS hh or MM SS
+#endif
+
+    for (uint8_t i = 0; i < TM1637_DIGITS / 2; i++)
+    {
+        data[2 * i] = shown[i] / 10;
+        data[2 * i + 1] = shown[i] % 10;
+    }
+    if (hours && data[0] == 0)
+    {
+        data[0] = 0x7f; // Unpadded hours, so h:mm doesn't read as MM:SS
+    }
+}
+
+/// @brief Timer wheel callback: the alarm rang for `RING_TICKS`.
+static void IRAM_ATTR onRingTimeout(void *clock) { ((Clock *)clock)->ring_timeout(); }
+
+/// @brief Timer wheel callback: a message was shown for `MESSAGE_TICKS`.
+static void IRAM_ATTR onMessageTimeout(void *clock) { ((Clock *)clock)->message_timeout(); }
+
+/// @brief Timer wheel callback: no button was pressed in a menu for `MENU_TIMEOUT_TICKS`.
+static void IRAM_ATTR onMenuTimeout(void *clock) { ((Clock *)clock)->menu_timeout(); }
+
+/// @brief Timer wheel callback: the snooze interval is over.
+static void IRAM_ATTR onSnooze(void *clock) { ((Clock *)clock)->snooze_timeout(); }
+
 /// @brief An empty Clock constructor.
 Clock::Clock() {}
 
@@ -67,10 +144,87 @@ void Clock::init(TM1637 *display, uint8_t buzzer_pin)
 /// @param hours The hours (24 hour format).
 /// @param minutes  Minutes
 /// @param seconds  Seconds
-void Clock::set_time(uint8_t hours, uint8_t minutes, uint8_t seconds)
+///
+/// The date is kept. The UTC epoch time is moved so the local time matches.
+void IRAM_ATTR Clock::set_time(uint8_t hours, uint8_t minutes, uint8_t seconds)
 {
-    time = 0x0000000 | hours << 12 | minutes << 6 | seconds;
-    timestamp = (hours * 3600 + minutes * 60 + seconds) * 1000;
+    int64_t local_ms = (int64_t)day * MS_PER_DAY + (hours * 3600 + minutes * 60 + seconds) * 1000;
+    set_epoch(local_ms - offset_ms);
+}
+
+/// @brief Set the local date. The time of day is kept.
+/// @param year Year, e.g. 2024.
+/// @param month Month, 1 to 12.
+/// @param day Day of the month, 1 to 31.
+void Clock::set_date(int16_t year, uint8_t month, uint8_t day)
+{
+    int64_t local_ms = (int64_t)days_from_civil(year, month, day) * MS_PER_DAY + timestamp;
+    set_epoch(local_ms - offset_ms);
+}
+
+/// @brief Set the time zone used to show the local time. The UTC epoch time is kept.
+///
+/// Set the time zone before the date and time, so they are interpreted in it.
+/// @param id One of the built-in time zones.
+void Clock::set_time_zone(TimeZoneId id)
+{
+    time_seq++; // Odd while the time is being updated, see `utc_us()`
+    zone = &TIME_ZONES[id];
+    localize();
+    time_seq++;
+    settings_changed = true;
+}
+
+/// @brief Set the UTC time.
+///
+/// Drops the time correction still being slewed.
+/// @param ms Milliseconds since 1970-01-01 UTC.
+void IRAM_ATTR Clock::set_epoch(int64_t ms)
+{
+    time_seq++; // Odd while the time is being updated, see `utc_us()`
+    epoch_ms = ms;
+    slew_us = 0;
+    carry_us = 0;
+    localize();
+    time_seq++;
+}
+
+/// @brief UTC time at a given monotonic time, with microsecond resolution.
+///
+/// Interpolates from the last tick with the monotonic counter. Safe to call from another task or core
+/// than the one advancing the time: the read is retried if a tick updated the time in the middle of it.
+/// @param mono_us Monotonic time (`esp_timer_get_time()`), in microseconds.
+/// @return Microseconds since 1970-01-01 UTC.
+int64_t Clock::utc_us(int64_t mono_us)
+{
+    uint32_t seq;
+    int64_t epoch, tick;
+    int32_t carry;
+    do
+    {
+        seq = time_seq.load(std::memory_order_acquire);
+        epoch = epoch_ms;
+        tick = last_tick_us;
+        carry = carry_us;
+        std::atomic_thread_fence(std::memory_order_acquire);
+    } while ((seq & 1) || seq != time_seq.load(std::memory_order_relaxed));
+
+    return epoch * 1000 + carry + (mono_us - tick);
+}
+
+/// @brief Correct the time by an offset measured by the host, e.g. with the serial sync protocol.
+///
+/// Offsets of `SYNC_STEP_MS` or more step the time on the next tick with `set_epoch()`, e.g. the
+/// years between the boot time (1970) and the host time; the sub-millisecond rest is slewed.
+/// Smaller offsets are slewed: each tick is lengthened or shortened by up to 2 ms per second
+/// (2000 ppm), so the display never jumps back. Replaces the part of the previous correction that
+/// is still being slewed, as the host measures the offset left after it. Safe to call from one
+/// other task or core than the one advancing the time. Dropped if 4 corrections are already
+/// pending, as the host measures again anyway.
+/// @param offset_us Host time minus clock time, in microseconds.
+void Clock::adjust(int64_t offset_us)
+{
+    adjustments.push(offset_us);
 }
 
 /// @brief Set the alarm hour, minutes and seconds.
@@ -78,9 +232,29 @@ void Clock::set_time(uint8_t hours, uint8_t minutes, uint8_t seconds)
 /// See `set_time()` method.
 /// @param hours Hours.
 /// @param minutes Minutes.
-void Clock::set_alarm(uint8_t hours, uint8_t minutes)
+void IRAM_ATTR Clock::set_alarm(uint8_t hours, uint8_t minutes)
 {
     this->alarm = 0x0000000 | hours << 12 | minutes << 6;
+    settings_changed = true;
+}
+
+/// @brief Set the days of the week the alarm rings on. Clears a date set by `set_alarm_date()`.
+/// @param weekdays Bit n set for weekday n (0 = Sunday), e.g. `WEEKDAYS`, `WEEKENDS` or `EVERY_DAY`.
+void Clock::set_alarm_days(uint8_t weekdays)
+{
+    alarm_days = weekdays;
+    alarm_date = -1;
+    settings_changed = true;
+}
+
+/// @brief Set a single date the alarm rings on, instead of the days of the week.
+/// @param year Year, e.g. 2024.
+/// @param month Month, 1 to 12.
+/// @param day Day of the month, 1 to 31.
+void Clock::set_alarm_date(int16_t year, uint8_t month, uint8_t day)
+{
+    alarm_date = days_from_civil(year, month, day);
+    settings_changed = true;
 }
 
 //
@@ -90,7 +264,7 @@ void Clock::set_alarm(uint8_t hours, uint8_t minutes)
 /// @brief A temporary variable to hold time adjusted by plus and minus buttons.The time isn't stored unless the OK button is pressed.
 ///        When in the set menus (for the alarm and the clock), this function modifies the time on the display by an offset.
 /// @param offset An offset to increment the Clock::time variable with. Negative offset decrements the time.
-void Clock::set_temp_time(int8_t offset)
+void IRAM_ATTR Clock::set_temp_time(int8_t offset)
 {
     int8_t hours = temp_time >> 12;
     int8_t minutes = temp_time >> 6 & 0b00000111111;
@@ -112,7 +286,7 @@ void Clock::set_temp_time(int8_t offset)
 ///
 /// The final storage can be either the `time` or `alarm` varialbe.
 /// Depends on the `time_to_set` class member (pointer variable).
-void Clock::commit_temp_time()
+void IRAM_ATTR Clock::commit_temp_time()
 {
     int8_t hours = temp_time >> 12;
     int8_t minutes = temp_time >> 6 & 0b00000111111;
@@ -129,8 +303,94 @@ void Clock::commit_temp_time()
 
 // -------------------- Handlers for Buttons and Switch Interrupt Service Routines --------------------
 
+/// @brief Entry point of the button ISRs.
+///
+/// In the dual-core mode, the press is queued for the timekeeping core, which owns the state machine.
+/// In the low-power mode, it is queued for `loop()`. Otherwise it is handled right away.
+/// The time of the press is read from the monotonic counter right away, so the stopwatch
+/// doesn't depend on when the press is handled.
+/// @param button The button that was pressed.
+void IRAM_ATTR Clock::press(ButtonType button)
+{
+    ButtonEvent event = {(uint8_t)button, esp_timer_get_time()};
+#if CLOCK_DUAL_CORE
+    if (buttons.push(event))
+    {
+        BaseType_t woken = pdFALSE;
+        xTaskNotifyFromISR(timekeeping_task, BUTTON_EVENT, eSetBits, &woken);
+        portYIELD_FROM_ISR(woken);
+    }
+#elif CLOCK_LOW_POWER
+    buttons.push(event); // Handled by `loop()` after the wake-up
+#else
+    handleButtonPress(button, event.time_us);
+#endif
+}
+
+/// @brief Turns a TM1637 key-scan code into button presses (`CLOCK_KEY_SCAN`).
+///
+/// The TM1637 reports the key for as long as it is held, so a press is reported once, when the key
+/// first appears. Keys other than `KEY_MENU`, `KEY_PLUS`, `KEY_MINUS` and `KEY_OK` are ignored.
+/// @param code Key-scan code read from the TM1637, `NO_KEY` if no key is pressed.
+void IRAM_ATTR Clock::scan_keys(uint8_t code)
+{
+    DRAM_ATTR static const int8_t KEYS[] = {KEY_MENU, KEY_PLUS, KEY_MINUS, KEY_OK}; // Indexed by `ButtonType`
+
+    int8_t key = TM1637::decodeKey(code);
+    if (key == last_key)
+    {
+        return;
+    }
+    last_key = key; // Before the press: the state machine may refresh the display, and scan again
+    for (uint8_t button = BUTTON_MENU; button <= BUTTON_OK; button++)
+    {
+        if (KEYS[button] == key)
+        {
+            press((ButtonType)button);
+        }
+    }
+}
+
+/// @brief Runs the state machine for a button press.
+/// @param button The button that was pressed.
+/// @param time_us Monotonic time of the press, in microseconds.
+void IRAM_ATTR Clock::handleButtonPress(ButtonType button, int64_t time_us)
+{
+    press_us = time_us;
+    switch (button)
+    {
+    case BUTTON_MENU:
+        handleButtonMenuPress();
+        break;
+    case BUTTON_PLUS:
+        handleButtonPlusPress();
+        break;
+    case BUTTON_MINUS:
+        handleButtonMinusPress();
+        break;
+    case BUTTON_OK:
+        handleButtonOkPress();
+        break;
+    }
+
+    switch (state)
+    {
+    case STATE_MENU_SET:
+    case STATE_MENU_ALARM:
+    case STATE_MENU_STOPWATCH:
+    case STATE_MENU_COUNTDOWN:
+    case STATE_SET_CLOCK:
+    case STATE_SET_ALARM:
+        timers.schedule(menu_timer, MENU_TIMEOUT_TICKS, onMenuTimeout, this); // Restart the menu inactivity timeout
+        break;
+    default:
+        timers.cancel(menu_timer);
+        break;
+    }
+}
+
 /// @brief Handles Menu button press.
-void Clock::handleButtonMenuPress()
+void IRAM_ATTR Clock::handleButtonMenuPress()
 {
     display_state = DIGITS_LEFT | POINT | DIGITS_RIGHT;
     switch (state)
@@ -138,18 +398,27 @@ void Clock::handleButtonMenuPress()
     case STATE_CLOCK:
     case STATE_MENU_SET:
     case STATE_MENU_ALARM:
-        state = (state + 1) % 3; // Cycle between the first three states, CLOCK, SET, and ALARM
+    case STATE_MENU_STOPWATCH:
+    case STATE_MENU_COUNTDOWN:
+        state = (state + 1) % MENU_STATES; // Cycle between the menu states, CLOCK, SET, ALARM, STOPWATCH and COUNTDOWN
+        break;
+    case STATE_STOPWATCH:    // The stopwatch and the countdown keep counting
+    case STATE_COUNTDOWN:    // in the background.
+        state = STATE_CLOCK;
         break;
     case STATE_SET_CLOCK:        // If the current state is SET_CLOCK
     case STATE_SET_ALARM:        // or SET_ALARM
         state = STATE_CLOCK;     // Pressing the menu button cancels the setting, returning back to the STATE_CLOCK
         set_digit = DIGITS_LEFT; // Put the focus back on the left digits of the display (hours).
         break;
+    case STATE_ALARM:
+        snooze(); // Pressing the menu button while the alarm rings snoozes it.
+        break;
     }
 }
 
 /// @brief Handles OK button press.
-void Clock::handleButtonOkPress()
+void IRAM_ATTR Clock::handleButtonOkPress()
 {
     display_state = DIGITS_LEFT | POINT | DIGITS_RIGHT; // The dipslay state will be 0b111. Displaying hours, minutes, and the middle colon
     switch (state)
@@ -168,8 +437,8 @@ void Clock::handleButtonOkPress()
         }
         else // Else if the alarm switch is turned off
         {
-            state = STATE_ALARM_OFF; // Move to the ALARM_OFF state, display "OFF" message to the user.
-            alarm_off_counter = 6;   // Set the counter to keep the displayed message to 6 * 0.5 = 3 seconds
+            state = STATE_ALARM_OFF;                                                   // Move to the ALARM_OFF state, display "OFF" message to the user.
+            timers.schedule(message_timer, MESSAGE_TICKS, onMessageTimeout, this); // Keep the displayed message for 6 * 0.5 = 3 seconds
         }
         break;
     case STATE_SET_CLOCK:
@@ -183,25 +452,78 @@ void Clock::handleButtonOkPress()
         break;
     case STATE_ALARM:
         state = STATE_CLOCK; // If the alarm is triggered, pressing the OK button returns to the clock state.
+        timers.cancel(ring_timer);
+        timers.cancel(snooze_timer);
+        break;
+    case STATE_MENU_STOPWATCH:
+        state = STATE_STOPWATCH;
+        break;
+    case STATE_MENU_COUNTDOWN:
+        state = STATE_COUNTDOWN;
+        break;
+    case STATE_STOPWATCH:                                // Start or stop the stopwatch, at the time of the press.
+        stopwatch_us = press_us - stopwatch_us;          // Running: start time shifted by the time counted before. Stopped: time counted.
+        stopwatch_running = !stopwatch_running;
+        lap_us = -1;
+        break;
+    case STATE_COUNTDOWN:                                // Start or pause the countdown, at the time of the press.
+        countdown_us = countdown_running ? countdown_us - press_us : press_us + countdown_us; // Running: end time. Paused: time left.
+        countdown_running = !countdown_running;
         break;
     }
 }
 
 /// @brief Handles `+` button press.
-void Clock::handleButtonPlusPress()
+void IRAM_ATTR Clock::handleButtonPlusPress()
 {
-    set_temp_time(+1); // Increment the temporary time on the display
+    switch (state)
+    {
+    case STATE_STOPWATCH: // Freeze the lap time on the display, or release it.
+        if (stopwatch_running)
+        {
+            lap_us = lap_us < 0 ? press_us - stopwatch_us : -1;
+        }
+        break;
+    case STATE_COUNTDOWN: // Lengthen the countdown by a minute.
+        if (!countdown_running && countdown_minutes < 99)
+        {
+            countdown_us = ++countdown_minutes * 60000000LL;
+            settings_changed = true;
+        }
+        break;
+    default:
+        set_temp_time(+1); // Increment the temporary time on the display
+        break;
+    }
 }
 
 /// @brief Handles `-` button press.
-void Clock::handleButtonMinusPress()
+void IRAM_ATTR Clock::handleButtonMinusPress()
 {
-    set_temp_time(-1); // Decrement the temporary time on the display
+    switch (state)
+    {
+    case STATE_STOPWATCH: // Reset the stopped stopwatch.
+        if (!stopwatch_running)
+        {
+            stopwatch_us = 0;
+        }
+        break;
+    case STATE_COUNTDOWN: // Shorten the countdown by a minute.
+        if (!countdown_running && countdown_minutes > 1)
+        {
+            countdown_us = --countdown_minutes * 60000000LL;
+            settings_changed = true;
+        }
+        break;
+    default:
+        set_temp_time(-1); // Decrement the temporary time on the display
+        break;
+    }
 }
 
 /// @brief Enables or disables alarm.
-///        Handles the alarm switch change.
-void Clock::handleSwitchAlarmChange(bool alarm_pin)
+///        Handles the alarm switch change. Called by the switch ISR, on any core: `alarm_enabled` is atomic.
+void IRAM_ATTR Clock::handleSwitchAlarmChange(bool alarm_pin)
 {
     alarm_enabled = alarm_pin; // Set the `alarm_poin` variable to either true or false, depends on whether the alarm switch is on or off.
 }
@@ -210,8 +532,18 @@ void Clock::handleSwitchAlarmChange(bool alarm_pin)
 
 /// @brief Show the time, alarm, or menu on display.
 ///
+/// Composes the next frame and renders it right away. See `compose()` and `render()`.
+void IRAM_ATTR Clock::show()
+{
+    Frame frame;
+    compose(frame);
+    render(frame);
+}
+
+/// @brief Compose the next frame to show: the time, alarm, or menu.
+///
 /// This function checks the current state stored in the class member
-/// variable `state` and changes the 7-segment display accordingly.
+/// variable `state` and fills the frame with the 7-segment data accordingly.
 /// The blinking is controlled by the `blink_state` variable.
 /// For example:
 /// If `blink_state = 0b100` (blinking the middle colon), and `display_state` = 0b111 (display all the objects hours, minutes, and middle colon),
@@ -221,55 +553,58 @@ void Clock::handleSwitchAlarmChange(bool alarm_pin)
 /// \f[
 ///     \mathrm{display\_state} = \mathrm{display\_state}  \oplus \mathrm{blink\_state}
 /// \f]
-void Clock::show()
+/// The menu labels and messages are taken already encoded from the configuration bundle (`config_bundle.h`).
+/// @param frame The frame to fill. Written by the timekeeping path, read by `render()`.
+void IRAM_ATTR Clock::compose(Frame &frame)
 {
+    frame.ringing = false;
     uint32_t *time_on_display = nullptr; // A pointer either to clock, alarm, or temporary setting time
 
     switch (state)
     {
     case STATE_CLOCK:
-        blink_state = POINT;     // Blink only the midddle colon
-        time_on_display = &time; // Display the time.
+        blink_state = colon_blink ? POINT : 0; // Blink only the midddle colon, if the colon blink is enabled
+        time_on_display = &time;               // Display the time.
         break;
     case STATE_SET_CLOCK:
     case STATE_SET_ALARM:
         blink_state = set_digit;      // Blink only the digit in focus (blink either the hours or minutes)
         time_on_display = &temp_time; // Display the `temp time` variable.
         break;
-    case STATE_ALARM: // Alarm triggered state
-        // Serial.println("Alarm Counter:");
-        // Serial.println(alarm_counter);
-        time_on_display = &alarm;                         // Display the alarm time.
+    case STATE_ALARM: // Alarm triggered state. `ring_timer` returns to the clock state.
+        time_on_display = &ring_time;                     // Display the alarm time (00:00 for the countdown).
         blink_state = DIGITS_LEFT | POINT | DIGITS_RIGHT; // Blink everything on the display (hours, minutes, and the middle colon)
-        alarm_tone->play();                               // Play the buzzer sound.
-        if (not --alarm_counter)                          // Decrement and check the alarm counter. When the `alarm_counter` is 0, execute the following:
-        {
-            state = STATE_CLOCK;                                // Return back to the clock state.
-            display_state = DIGITS_LEFT | POINT | DIGITS_RIGHT; // Display all objects.
-            blink_state = POINT;                                // Blink only the middle colon.
-        }
+        frame.ringing = true;                             // Play the buzzer sound.
         break;
     }
 
     int8_t hours, minutes, seconds;
-    int8_t data[4];    // An array of four digits to be sent to the display (two for hours and two for minutes)
+    int8_t data[TM1637_DIGITS]; // An array of digits to be sent to the display (two for hours, two for minutes and, on 6-digit modules, two for seconds)
     display->point(0); // Turn off the middle colon
 
     switch (state)
     {
     case STATE_MENU_SET:
-        display->displayStr("SET", 0);
-        break;
+        label(frame, LABEL_SET);
+        return;
     case STATE_MENU_ALARM:
-        display->displayStr("AL", 0);
+        label(frame, LABEL_ALARM);
+        return;
+    case STATE_MENU_STOPWATCH:
+        label(frame, LABEL_STOPWATCH);
+        return;
+    case STATE_MENU_COUNTDOWN:
+        label(frame, LABEL_COUNTDOWN);
+        return;
+    case STATE_STOPWATCH:
+    case STATE_COUNTDOWN:
+        duration(data, state == STATE_STOPWATCH ? (lap_us < 0 ? stopwatch_elapsed(esp_timer_get_time()) : lap_us)
+                                                : countdown_left(esp_timer_get_time()));
+        display->point(POINT_ON);
         break;
     case STATE_ALARM_OFF:
-        display->displayStr("OFF", 0);
-        if (not --alarm_off_counter) // Decrement the counter, and check if it is zero execute the following block
-        {
-            state = STATE_CLOCK; // Return to the clock state.
-        }
-        break;
+        label(frame, LABEL_OFF); // `message_timer` returns to the clock state.
+        return;
     case STATE_CLOCK:
     case STATE_ALARM:
     case STATE_SET_CLOCK:
@@ -309,22 +644,265 @@ void Clock::show()
             data[2] = data[3] = 0x7f; // Turn off the minutes digits in the 7-segment display
         }
 
-        display->display(data); // Send the data array to the 7-segment display.
+#if TM1637_DIGITS == 6
+        data[4] = seconds / 10; // Display the first digit of the seconds.
+        data[5] = seconds % 10; // Display the right digit of the seconds.
+#endif
         break;
     }
+
+    for (uint8_t i = 0; i < TM1637_DIGITS; i++)
+    {
+        frame.segments[i] = display->coding(data[i], i); // Encode the digits and characters to 7-segment data.
+    }
+}
+
+/// @brief Render a composed frame: send it to the display and sequence the buzzer.
+/// @param frame The frame filled by `compose()`.
+void IRAM_ATTR Clock::render(const Frame &frame)
+{
+#if CLOCK_KEY_SCAN
+    uint8_t keys;
+    display->displaySegments(frame.segments, &keys); // Send the frame, and read the keys at the end of the same refresh.
+    scan_keys(keys);
+#else
+    display->displaySegments(frame.segments); // Send the frame to the 7-segment display in a single transfer.
+#endif
+    if (frame.ringing)
+    {
+        alarm_tone->play(); // Play the buzzer sound.
+    }
+    else if (alarm_tone->playing())
+    {
+        alarm_tone->stop(); // The alarm stopped ringing: timeout, snooze or OK.
+    }
+}
+
+/// @brief Whether the buzzer plays: from the first frame rendered while the alarm rings, until
+///        the first one rendered after it stopped ringing. See `render()`.
+bool Clock::buzzing()
+{
+    return alarm_tone->playing();
+}
+
+/// @brief The state of the clock, one of `ClockState`.
+uint8_t Clock::current_state()
+{
+    return state;
 }
 
 /// @brief Check if alarm needs to be triggered.
-///        Called by the ISR. If the current time equals the alarm time. It changes the state to `STATE_ALARM`
-///        and sets the alarm down counter to 30 seconds.
+///        Called by the ISR. If the current time equals the alarm time, and the alarm recurs on the current day
+///        (see `set_alarm_days()` and `set_alarm_date()`), it changes the state to `STATE_ALARM`
+///        and rings for 30 seconds. See `start_ringing()`.
+///        The preset alarms of the configuration bundle ring the same way, on their own days.
+void IRAM_ATTR Clock::check_alarm()
+{
+    bool alarm_today = alarm_date < 0 ? (alarm_days >> weekday) & 1 : day == alarm_date; // Recurrence: a weekday mask or a single date
+
+    if (alarm_enabled && time == alarm && alarm_today)
+    {
+        ring_time = alarm;
+        start_ringing();
+        return;
+    }
+
+    for (uint16_t i = 0; alarm_enabled && i < config_bundle.alarm_count(); i++) // Preset alarms of the configuration bundle
+    {
+        const BundleAlarm &preset = config_bundle.alarms()[i];
+        uint32_t preset_time = (uint32_t)preset.hour << 12 | preset.minute << 6;
+        if ((preset.flags & ALARM_PRESET_ENABLED) && (preset.days >> weekday & 1) && time == preset_time)
+        {
+            ring_time = preset_time;
+            start_ringing();
+            return;
+        }
+    }
+}
+
+/// @brief Check if the countdown is over, and ring the alarm if it is.
+///        Called on every timer interrupt, so the countdown ends within 50 ms when shown, 0.5 seconds otherwise.
+///        In the low-power mode, `next_deadline_ms()` wakes the CPU up when it ends.
+void IRAM_ATTR Clock::check_countdown()
+{
+    if (countdown_running && esp_timer_get_time() >= countdown_us)
+    {
+        countdown_running = false;
+        countdown_us = countdown_minutes * 60000000LL; // Ready to start again
+        ring_time = 0;                                 // Show 00:00 while ringing
+        start_ringing(false);                          // Not snoozable: the countdown isn't an alarm to repeat
+    }
+}
+
+// -------------------- Stopwatch and countdown --------------------
+
+/// @brief Whether a running stopwatch or countdown is on display, and needs the fast refresh.
+bool IRAM_ATTR Clock::fast_refresh()
+{
+    return (state == STATE_STOPWATCH && stopwatch_running && lap_us < 0) || (state == STATE_COUNTDOWN && countdown_running);
+}
+
+/// @brief Switch the timer interrupt between every 0.5 seconds and every 50 ms, depending on `fast_refresh()`.
+///
+/// Called on 0.5 second tick boundaries only. The timer counter just reloaded, so changing the
+/// period keeps the tick phase and the clock keeps its accuracy.
+/// The interrupt rate is only raised while a running stopwatch or countdown is shown, or with
+/// `CLOCK_KEY_SCAN`, to poll the keys while they are in use: while a key is down or out of the
+/// clock state. The clock state reads them with its 0.5 second refresh only.
+void IRAM_ATTR Clock::update_divider()
+{
+    bool keys_in_use = CLOCK_KEY_SCAN && (last_key >= 0 || state != STATE_CLOCK); // The keys are scanned every 50 ms
+    uint8_t wanted = keys_in_use || fast_refresh() ? FAST_TICK_DIVIDER : 1;
+    if (wanted != divider && timer)
+    {
+        divider = wanted;
+#if CLOCK_DUAL_CORE
+        timerAlarmWrite(timer, 500000 / divider, true); // From the timekeeping task
+#else
+        timer_group_set_alarm_value_in_isr(TIMER_GROUP_0, TIMER_0, 500000 / divider); // Timer 0 of `setup_timer()`. In IRAM, unlike `timerAlarmWrite()`.
+#endif
+    }
+}
+
+/// @brief Stopwatch time.
+/// @param now_us Monotonic time, in microseconds.
+/// @return Microseconds counted by the stopwatch.
+int64_t IRAM_ATTR Clock::stopwatch_elapsed(int64_t now_us)
+{
+    return stopwatch_running ? now_us - stopwatch_us : stopwatch_us;
+}
+
+/// @brief Countdown time left.
+/// @param now_us Monotonic time, in microseconds.
+/// @return Microseconds left, 0 when the countdown is over.
+int64_t IRAM_ATTR Clock::countdown_left(int64_t now_us)
+{
+    int64_t left = countdown_running ? countdown_us - now_us : countdown_us;
+    return left > 0 ? left : 0;
+}
+
+/// @brief Set the snooze repeat interval.
+/// @param minutes Minutes between pressing the menu button while the alarm rings and the next ring. 0 disables the snooze.
+void Clock::set_snooze(uint8_t minutes)
+{
+    snooze_minutes = minutes;
+    settings_changed = true;
+}
+
+// -------------------- Settings kept across resets --------------------
+
+/// @brief The current settings, to be stored.
+ClockSettings Clock::settings()
+{
+    return {alarm, alarm_date, alarm_days, (uint8_t)(zone - TIME_ZONES), snooze_minutes, countdown_minutes};
+}
+
+/// @brief Restore stored settings. Called from `setup()`, before the clock runs.
+///
+/// Settings out of range are ignored. Restoring doesn't count as a change.
+/// @param settings The stored settings.
+void Clock::restore(const ClockSettings &settings)
+{
+    uint8_t hours = settings.alarm >> 12;
+    uint8_t minutes = settings.alarm >> 6 & 0b111111;
+    if (hours < 24 && minutes < 60)
+    {
+        alarm = (uint32_t)hours << 12 | minutes << 6;
+    }
+    alarm_days = settings.alarm_days & EVERY_DAY;
+    alarm_date = settings.alarm_date < 0 ? -1 : settings.alarm_date;
+    if (settings.time_zone < TZ_COUNT)
+    {
+        set_time_zone((TimeZoneId)settings.time_zone);
+    }
+    snooze_minutes = settings.snooze_minutes;
+    if (settings.countdown_minutes >= 1 && settings.countdown_minutes <= 99)
+    {
+        countdown_minutes = settings.countdown_minutes;
+        countdown_us = countdown_minutes * 60000000LL;
+    }
+    settings_changed = false;
+}
+
+/// @brief Whether a setting changed since the last call. Called by the settings store, from `loop()`.
+bool Clock::take_settings_changed()
+{
+    return settings_changed.exchange(false);
+}
+
+/// @brief Ring the alarm: changes the state to `STATE_ALARM` for `RING_TICKS` (30 seconds).
 ///        also modifies the blinking state to blink both the left and rigth digits and the midddle colon.
-void Clock::check_alarm()
+/// @param snoozable Whether the menu button snoozes the ring. The end of a countdown isn't: the menu button just stops it.
+void IRAM_ATTR Clock::start_ringing(bool snoozable)
 {
-    if (alarm_enabled && time == alarm)
+    ring_snoozable = snoozable;
+    state = STATE_ALARM;
+    display_state = DIGITS_LEFT | POINT | DIGITS_RIGHT;
+    timers.schedule(ring_timer, RING_TICKS, onRingTimeout, this);
+    timers.cancel(menu_timer); // The alarm leaves any menu
+}
+
+/// @brief Snooze the ringing alarm: stop it, and ring again after the snooze interval.
+///        The end of a countdown, or any ring with the snooze disabled, is only stopped, as with OK. See `start_ringing()`.
+void IRAM_ATTR Clock::snooze()
+{
+    state = STATE_CLOCK;
+    display_state = DIGITS_LEFT | POINT | DIGITS_RIGHT;
+    timers.cancel(ring_timer);
+    if (ring_snoozable && snooze_minutes)
+    {
+        timers.schedule(snooze_timer, snooze_minutes * TICKS_PER_MINUTE, onSnooze, this);
+    }
+    else
     {
-        state = STATE_ALARM;
-        alarm_counter = 60; // Set the counter for 0.5 * 60 = 30 seconds
+        timers.cancel(snooze_timer);
+    }
+}
+
+/// @brief The snooze interval is over: ring again, unless the alarm switch was turned off meanwhile.
+///
+/// The switch is checked here rather than cancelling the snooze from the switch ISR, which may
+/// run on another core than the timer wheel.
+void IRAM_ATTR Clock::snooze_timeout()
+{
+    if (alarm_enabled)
+    {
+        start_ringing();
+    }
+}
+
+/// @brief The alarm rang for `RING_TICKS`: return back to the clock state.
+void IRAM_ATTR Clock::ring_timeout()
+{
+    state = STATE_CLOCK;                                // Return back to the clock state.
+    display_state = DIGITS_LEFT | POINT | DIGITS_RIGHT; // Display all objects.
+    blink_state = POINT;                                // Blink only the middle colon.
+}
+
+/// @brief A message was shown for `MESSAGE_TICKS`: return back to the clock state.
+void IRAM_ATTR Clock::message_timeout()
+{
+    if (state == STATE_ALARM_OFF)
+    {
+        state = STATE_CLOCK;
+    }
+}
+
+/// @brief No button was pressed in a menu for `MENU_TIMEOUT_TICKS`: cancel the setting, as the menu button would.
+void IRAM_ATTR Clock::menu_timeout()
+{
+    switch (state)
+    {
+    case STATE_MENU_SET:
+    case STATE_MENU_ALARM:
+    case STATE_MENU_STOPWATCH:
+    case STATE_MENU_COUNTDOWN:
+    case STATE_SET_CLOCK:
+    case STATE_SET_ALARM:
+        state = STATE_CLOCK;
+        set_digit = DIGITS_LEFT;
         display_state = DIGITS_LEFT | POINT | DIGITS_RIGHT;
+        break;
     }
 }
 
@@ -375,11 +953,97 @@ void Clock::setup_timer()
 ///
 /// Adds 0.5 seconds (500 milliseconds). Resets the counter every day.
 /// @f$\mathrm{timestamp\;} = (\mathrm{\;timestamp\;} + 500) \mathrm{\;mod\;} (24 \times 60 \times 60 \times 1000)@f$
-void Clock::update_time()
+void IRAM_ATTR Clock::update_time()
+{
+    advance_time(500, esp_timer_get_time()); // Add 0.5 seconds (500 milliseconds).
+}
+
+/// @brief Increments the timestamp by an arbitrary number of milliseconds.
+///
+/// Used by the low-power mode, where the CPU sleeps for more than one 0.5 second tick.
+/// Advances the UTC epoch time, and the local time of day incrementally: the date is only
+/// recomputed when the day rolls over, and the time zone offset when a DST change is due.
+/// Applies the pending `adjust()` corrections, stepping or slewing the time.
+/// @param ms Milliseconds to add to the timestamp.
+/// @param mono_us Monotonic time the new timestamp corresponds to, in microseconds.
+void IRAM_ATTR Clock::advance_time(uint32_t ms, int64_t mono_us)
 {
-    timestamp = (timestamp + 500) % (24 * 60 * 60 * 1000); // Add 0.5 seconds (500 milliseconds). Reset the counter after 1 day
-                                                           // The timestamp variable is in milliseconds.
+    wheel_ms += ms; // The timer wheel counts elapsed time, so setting the time doesn't move the timers
+    while (wheel_ms >= 500)
+    {
+        wheel_ms -= 500;
+        timers.tick();
+    }
+
+    int64_t offset;
+    while (adjustments.pop(offset))
+    {
+        if (offset >= SYNC_STEP_MS * 1000LL || offset <= -SYNC_STEP_MS * 1000LL) // Far off: step the time
+        {
+            int32_t rest = offset % 1000;
+            rest += rest < 0 ? 1000 : 0;
+            set_epoch(epoch_ms + (offset - rest) / 1000);
+            slew_us = rest; // Slew the sub-millisecond rest
+        }
+        else
+        {
+            slew_us = offset; // Close: slew it
+        }
+    }
 
+    int32_t slewed = 0;
+    if (slew_us) // Slew by up to 1 ms per 0.5 second
+    {
+        int32_t max_us = (ms + 499) / 500 * 1000; // Never more than `ms`, so time doesn't run backwards
+        slewed = slew_us > max_us ? max_us : slew_us < -max_us ? -max_us : slew_us;
+        slew_us -= slewed;
+    }
+
+    time_seq++; // Odd while the time is being updated, see `utc_us()`, which reads the carry too
+    carry_us += slewed;
+    int32_t step = floor_div(carry_us, 1000); // Whole milliseconds go to the epoch time, the rest stays in the carry
+    carry_us -= step * 1000;
+    last_tick_us = mono_us;
+    epoch_ms += (int32_t)ms + step;
+
+    if (epoch_ms >= next_offset_change) // A DST change is due
+    {
+        localize(); // Recompute the offset and the local time
+    }
+    else
+    {
+        timestamp += (int32_t)ms + step; // The timestamp variable is the local time of day, in milliseconds.
+        while (timestamp >= MS_PER_DAY)  // Reset the counter every day, and move to the next date
+        {
+            timestamp -= MS_PER_DAY;
+            day++;
+            date = civil_from_days(day);
+            weekday = weekday_from_days(day);
+        }
+        pack_time();
+    }
+    time_seq++;
+}
+
+/// @brief Recompute the time zone offset, the local date and the local time of day from the UTC epoch time.
+///
+/// Called when the time, date or time zone are set, and on DST changes.
+void IRAM_ATTR Clock::localize()
+{
+    offset_ms = utc_offset_ms(*zone, epoch_ms, &next_offset_change);
+    int64_t local_ms = epoch_ms + offset_ms;
+    day = floor_div(local_ms, MS_PER_DAY);
+    timestamp = local_ms - (int64_t)day * MS_PER_DAY;
+    date = civil_from_days(day);
+    weekday = weekday_from_days(day);
+    pack_time();
+}
+
+/// @brief Store the local time of day in the binary representation of the `time` variable.
+///
+/// See `set_time()` method.
+void IRAM_ATTR Clock::pack_time()
+{
     uint8_t hour = timestamp / 3600000;
     uint8_t minutes = (timestamp % 3600000) / 60000;
     uint8_t seconds = (timestamp % 60000) / 1000;
@@ -387,11 +1051,269 @@ void Clock::update_time()
     time = 0x0000000 | hour << 12 | minutes << 6 | seconds;
 }
 
+/// @brief Show the first frame, before the clock runs.
+///
+/// The display is cleared and the frame shown in a single transfer (`TM1637::begin()`),
+/// instead of one transaction per digit to clear it and another transfer for the frame.
+void Clock::show_first_frame()
+{
+    Frame frame;
+    compose(frame);
+    display->begin(frame.segments);
+}
+
 /// @brief Start running the clock
 ///               This function MUST not block, everything should be handled
 ///               by interrupts
+///
+/// Call `show_first_frame()` first: the next frame is shown on the first tick.
 void Clock::run()
 {
-    this->show();
+    start_us = last_tick_us = esp_timer_get_time();
+#if CLOCK_DUAL_CORE
+    this->start_tasks();
+#elif !CLOCK_LOW_POWER
     this->setup_timer();
+#endif
+}
+
+/// @brief Advances the time by one 0.5 second tick, checks the alarm and refreshes the display.
+///        Called by the timer ISR every 0.5 seconds, or every 50 ms while a running stopwatch or countdown is shown.
+void IRAM_ATTR Clock::tick()
+{
+    wakeups++;
+    check_countdown();
+
+    bool base_tick = ++sub_tick >= divider; // With the fast refresh, only every `FAST_TICK_DIVIDER`-th interrupt is a 0.5 second tick
+    if (base_tick)
+    {
+        sub_tick = 0;
+        update_time();
+        check_alarm();
+    }
+    if (base_tick || fast_refresh()) // Between 0.5 second ticks, only the stopwatch or countdown is refreshed
+    {
+#if CLOCK_DUAL_CORE
+        compose(frames.write_slot());
+        frames.publish();             // Hand the frame over to the render core
+        xTaskNotifyGive(render_task);
+#else
+        show();
+#endif
+    }
+#if CLOCK_KEY_SCAN
+    else
+    {
+        scan_keys(display->readKeys()); // No refresh due: read the keys alone
+    }
+#endif
+    if (base_tick)
+    {
+        update_divider();
+    }
+}
+
+// -------------------- Low-power (tickless) mode --------------------
+
+/// @brief Enables or disables the blinking of the middle colon in the clock state.
+///
+/// With the colon steady, the clock state only changes the display on minute rollovers
+/// (second rollovers on 6-digit modules), which lets the low-power mode sleep between them.
+/// @param enabled `true` to blink the colon every 0.5 seconds, `false` to keep it on.
+void Clock::set_colon_blink(bool enabled)
+{
+    colon_blink = enabled;
+    display_state = DIGITS_LEFT | POINT | DIGITS_RIGHT; // Display all objects, so the colon doesn't stay off.
+}
+
+/// @brief Milliseconds until the display or the alarm must change.
+///
+/// The menus, the blinking digits, and the alarm and "OFF" counters advance every 0.5 seconds,
+/// so outside the clock state the deadline is the next 0.5 second phase of the timestamp.
+/// In the clock state with a steady colon, the display only changes when the minutes (or seconds) roll over.
+/// Alarms are set in whole minutes, so the minute rollover also covers the next alarm.
+/// Timers pending on the timer wheel bring the deadline forward, and so does the end of a running
+/// countdown, which rings even when the clock is shown.
+/// @return Milliseconds from the current timestamp to the next deadline.
+uint32_t Clock::next_deadline_ms()
+{
+    uint32_t period = 500; // Blink and counter phase
+
+    if (state == STATE_CLOCK && !colon_blink)
+    {
+        period = TM1637_DIGITS == 6 ? 1000 : 60000; // Seconds or minutes rollover
+    }
+    else if (fast_refresh())
+    {
+        period = 500 / FAST_TICK_DIVIDER; // Running stopwatch or countdown
+    }
+    uint32_t deadline = period - timestamp % period;
+
+    uint32_t ticks = timers.ticks_to_next(); // Pending timers, e.g. the snooze
+    if (ticks != UINT32_MAX && ticks * 500 - wheel_ms < deadline)
+    {
+        deadline = ticks * 500 - wheel_ms;
+    }
+    if (countdown_running)
+    {
+        int64_t left_us = countdown_us - esp_timer_get_time();
+        uint32_t left_ms = left_us > 0 ? (uint32_t)((left_us + 999) / 1000) : 1; // Never 0, so the CPU doesn't spin
+        if (left_ms < deadline)
+        {
+            deadline = left_ms;
+        }
+    }
+    return deadline;
+}
+
+/// @brief Sleeps the CPU until the next deadline or a button wake-up.
+///
+/// In the clock state the CPU enters light sleep. The buttons are configured as GPIO wake-up
+/// sources in `setup()`. In the other states the buzzer and the blinking need the peripherals
+/// clocked, so the task is only delayed.
+/// On wake-up, the timestamp is advanced by the elapsed monotonic time. The alarm and the display
+/// are only updated when a 0.5 second phase has been crossed, to keep the blinking cadence of the periodic mode.
+void Clock::sleep_until_next_deadline()
+{
+    uint32_t sleep_ms = next_deadline_ms();
+
+    if (state == STATE_CLOCK)
+    {
+        Serial.flush(); // The UART stops during light sleep.
+        esp_sleep_enable_timer_wakeup((uint64_t)sleep_ms * 1000);
+        esp_light_sleep_start();
+    }
+    else
+    {
+        delay(sleep_ms);
+    }
+    wakeups++;
+
+    uint32_t elapsed_ms = (esp_timer_get_time() - last_tick_us) / 1000;
+    uint32_t previous_phase = timestamp / 500;
+    advance_time(elapsed_ms, last_tick_us + (int64_t)elapsed_ms * 1000); // Keep the sub-millisecond remainder for the next wake-up
+
+#if CLOCK_LOW_POWER
+    ButtonEvent event;
+    while (buttons.pop(event)) // Handle the presses queued by the button ISRs
+    {
+        handleButtonPress((ButtonType)event.button, event.time_us);
+    }
+#endif
+    bool counting = countdown_running;
+    check_countdown();
+
+    if (timestamp / 500 == previous_phase) // No 0.5 second phase crossed: a button, the fast refresh or the countdown woke the CPU
+    {
+        if (fast_refresh() || (counting && !countdown_running)) // Show the ring at the end of the countdown now
+        {
+            show();
+        }
+    }
+    else
+    {
+        check_alarm();
+        show();
+
+        if (timestamp % 3600000 < elapsed_ms) // The hour rolled over
+        {
+            Serial.printf("[power] %u wakeups/h\n", (unsigned)wakeups_per_hour());
+        }
+    }
+}
+
+/// @brief Average CPU wake-ups per hour since the clock started running.
+/// @return Wake-ups per hour.
+uint32_t Clock::wakeups_per_hour()
+{
+    int64_t uptime_us = esp_timer_get_time() - start_us;
+    if (uptime_us <= 0)
+    {
+        return 0;
+    }
+    return (uint64_t)wakeups * 3600000000ULL / uptime_us;
+}
+
+// -------------------- Dual-core tasks --------------------
+
+#if CLOCK_DUAL_CORE
+/// @brief Create the clock tasks and pin them to their cores.
+void Clock::start_tasks()
+{
+    xTaskCreatePinnedToCore(renderTask, "render", 4096, this, 2, &render_task, RENDER_CORE);
+    xTaskCreatePinnedToCore(consoleTask, "console", 4096, this, 1, &console_task, RENDER_CORE);
+    xTaskCreatePinnedToCore(timekeepingTask, "timekeeping", 4096, this, configMAX_PRIORITIES - 1, &timekeeping_task, TIMEKEEPING_CORE);
+}
+
+/// @brief Timekeeping task body. Owns the time, the alarm and the state machine.
+///
+/// Attaches the timer interrupt from its own core, so the ISR runs on `TIMEKEEPING_CORE` too.
+/// Wakes up on timer ticks and queued button presses.
+void Clock::timekeeping_loop()
+{
+    setup_timer();
+
+    for (;;)
+    {
+        uint32_t events = 0;
+        xTaskNotifyWait(0, UINT32_MAX, &events, portMAX_DELAY);
+        int64_t start = esp_timer_get_time();
+
+        ButtonEvent event;
+        while (buttons.pop(event)) // Handle the presses before the tick, as the single-core ISRs would
+        {
+            handleButtonPress((ButtonType)event.button, event.time_us);
+        }
+        if (events & TICK_EVENT)
+        {
+            tick();
+        }
+
+        busy_us[TIMEKEEPING_CORE] += esp_timer_get_time() - start;
+    }
+}
+
+/// @brief Render task body. Sends the latest frame to the display and sequences the buzzer.
+///
+/// A slow display transfer only delays this task; the timekeeping core keeps publishing newer frames.
+void Clock::render_loop()
+{
+    for (;;)
+    {
+        ulTaskNotifyTake(pdTRUE, portMAX_DELAY);
+        int64_t start = esp_timer_get_time();
+
+        if (frames.fetch())
+        {
+            render(frames.read_slot());
+        }
+
+        busy_us[RENDER_CORE] += esp_timer_get_time() - start;
+    }
+}
+
+/// @brief Console task body. Reports the per-core utilization of the clock tasks on the serial port.
+void Clock::console_loop()
+{
+    int64_t last = esp_timer_get_time();
+    uint32_t last_busy[2] = {busy_us[0], busy_us[1]};
+
+    for (;;)
+    {
+        vTaskDelay(pdMS_TO_TICKS(CONSOLE_REPORT_MS));
+        int64_t start = esp_timer_get_time();
+        uint32_t window = start - last;
+
+        for (uint8_t core = 0; core < 2; core++)
+        {
+            uint32_t busy = busy_us[core];
+            uint32_t permille = (uint64_t)(busy - last_busy[core]) * 1000 / window;
+            Serial.printf("[cpu] core%u %u.%u%%\n", (unsigned)core, (unsigned)(permille / 10), (unsigned)(permille % 10));
+            last_busy[core] = busy;
+        }
+
+        last = start;
+        busy_us[RENDER_CORE] += esp_timer_get_time() - start;
+    }
 }
+#endif
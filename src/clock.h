@@ -9,6 +9,71 @@
 #include <Arduino.h>
 #include "tm1637.h"
 #include "alarm_tone.h"
+#include "handoff.h"
+#include "calendar.h"
+#include "timer_wheel.h"
+#include "config_bundle.h"
+
+/// @brief Low-power (tickless) mode.
+///
+/// When set to 1, the periodic 0.5 second timer is not started. Instead, `loop()` calls
+/// `Clock::sleep_until_next_deadline()`, which sleeps the CPU until the display or the alarm
+/// must change, or until a button wakes it up.
+/// Override with a build flag, e.g. `-DCLOCK_LOW_POWER=1`
+#ifndef CLOCK_LOW_POWER
+#define CLOCK_LOW_POWER 0
+#endif
+
+/// @brief Dual-core execution model.
+///
+/// When set to 1, timekeeping, the alarm check and the button state machine run in a task pinned
+/// to `TIMEKEEPING_CORE`, together with the timer interrupt. The display refresh and the buzzer run in
+/// a render task, and the serial console in a console task, both pinned to `RENDER_CORE`.
+/// The cores only share data through the lock-free structures in `handoff.h`.
+/// Override with a build flag, e.g. `-DCLOCK_DUAL_CORE=1`
+#ifndef CLOCK_DUAL_CORE
+#define CLOCK_DUAL_CORE 0
+#endif
+
+#if CLOCK_DUAL_CORE && CLOCK_LOW_POWER
+#error "CLOCK_DUAL_CORE and CLOCK_LOW_POWER can't be enabled together"
+#endif
+
+/// @brief Key-scan input.
+///
+/// When set to 1, the four buttons are wired to the key-scan matrix of the TM1637 (see `KEY_MENU`)
+/// instead of GPIOs. The keys are read at the end of each display refresh, in the same bus
+/// transaction sequence. In the clock state that is every 0.5 seconds, so a press there may take
+/// up to 0.5 seconds to register. Once a key is down, and out of the clock state (menus, alarm),
+/// the timer runs every 50 ms and reads the keys alone when no refresh is due (about 0.6 ms in the ISR).
+/// The alarm switch stays on its GPIO: the TM1637 only reports one key at a time.
+/// Override with a build flag, e.g. `-DCLOCK_KEY_SCAN=1`
+#ifndef CLOCK_KEY_SCAN
+#define CLOCK_KEY_SCAN 0
+#endif
+
+#if CLOCK_KEY_SCAN && (CLOCK_DUAL_CORE || CLOCK_LOW_POWER)
+#error "CLOCK_KEY_SCAN can't be combined with CLOCK_DUAL_CORE or CLOCK_LOW_POWER"
+#endif
+
+#define TIMEKEEPING_CORE 0     ///< Core running the timer interrupt, timekeeping and the state machine
+#define RENDER_CORE 1          ///< Core running the display refresh, the buzzer and the serial console
+#define CONSOLE_REPORT_MS 5000 ///< Period of the per-core utilization report on the serial console
+
+#define TICKS_PER_MINUTE 120      ///< Clock ticks (0.5 seconds) in a minute
+#define RING_TICKS 60             ///< Alarm ringing time: 60 * 0.5 = 30 seconds
+#define MESSAGE_TICKS 6           ///< Display time of messages ("OFF"): 6 * 0.5 = 3 seconds
+#define MENU_TIMEOUT_TICKS 60     ///< Menu inactivity timeout: 60 * 0.5 = 30 seconds
+#define DEFAULT_SNOOZE_MINUTES 5  ///< Snooze repeat interval
+#define FAST_TICK_DIVIDER 10      ///< Timer interrupts per 0.5 second tick while a running stopwatch or countdown is shown (every 50 ms)
+#define DEFAULT_COUNTDOWN_MINUTES 5 ///< Initial countdown duration
+#define DURATION_MAX_US 359999990000LL ///< Longest duration shown: 99 hours 59:59.99. The stopwatch stays there.
+#define SYNC_STEP_MS 1000         ///< Time corrections of at least this much are stepped instead of slewed
+
+#define KEY_MENU 0  ///< TM1637 key of the MENU button: SG1 and K1. See `TM1637::decodeKey()`.
+#define KEY_PLUS 1  ///< TM1637 key of the PLUS button: SG2 and K1
+#define KEY_MINUS 2 ///< TM1637 key of the MINUS button: SG3 and K1
+#define KEY_OK 3    ///< TM1637 key of the OK button: SG4 and K1
 
 // ----------- By Fady -------------------
 //
@@ -16,17 +81,23 @@
 /// @brief An enum to define the states of the clock.
 enum ClockState
 {
-    // Note: the first three states need to be in this exact order
-    STATE_CLOCK = 0,      ///< Normal state. Display clock.
-    STATE_MENU_SET = 1,   ///< Menu (Displaying "SET")
-    STATE_MENU_ALARM = 2, ///< Menu (Displaying "AL")
-                          // ------------------------
-    STATE_SET_CLOCK = 3,  ///< Set clock state. Blinking the selected digit being set.
-    STATE_SET_ALARM = 4,  ///< Set alarm state. Blinking the selected digit being set.
-    STATE_ALARM_OFF = 5,  ///< Menu after selecting alarm if the alarm is off (Displaying "OFF")
-    STATE_ALARM = 6,      ///< The alarm state. The buzzer sounds and the display is blinking with the alarm time.
+    // Note: the first `MENU_STATES` states need to be in this exact order
+    STATE_CLOCK = 0,          ///< Normal state. Display clock.
+    STATE_MENU_SET = 1,       ///< Menu (Displaying "SET")
+    STATE_MENU_ALARM = 2,     ///< Menu (Displaying "AL")
+    STATE_MENU_STOPWATCH = 3, ///< Menu (Displaying "StP")
+    STATE_MENU_COUNTDOWN = 4, ///< Menu (Displaying "Cnt")
+                              // ------------------------
+    STATE_SET_CLOCK = 5,      ///< Set clock state. Blinking the selected digit being set.
+    STATE_SET_ALARM = 6,      ///< Set alarm state. Blinking the selected digit being set.
+    STATE_ALARM_OFF = 7,      ///< Menu after selecting alarm if the alarm is off (Displaying "OFF")
+    STATE_ALARM = 8,          ///< The alarm state. The buzzer sounds and the display is blinking with the alarm time.
+    STATE_STOPWATCH = 9,      ///< Stopwatch. Displaying SS:hh under a minute, MM:SS above, h:mm from 100 minutes.
+    STATE_COUNTDOWN = 10,     ///< Countdown timer. Displaying SS:hh under a minute, MM:SS above.
 };
 
+#define MENU_STATES 5 ///< Number of states cycled by the menu button
+
 /// @enum The digit state (Whether the digit in focus is the left or right state).
 ///        Also used to indicate which parts of the display is blinking
 enum DigitState
@@ -46,6 +117,33 @@ enum ButtonType
     BUTTON_OK,
 };
 
+/// @brief A button press, with the time it happened at.
+struct ButtonEvent
+{
+    uint8_t button; ///< `ButtonType` of the pressed button
+    int64_t time_us; ///< Monotonic time of the press, in microseconds
+};
+
+/// @brief A display frame. Composed by the timekeeping path and rendered by the display path.
+struct Frame
+{
+    uint8_t segments[TM1637_DIGITS]; ///< Encoded 7-segment data, one byte per digit.
+    bool ringing;                    ///< Whether the buzzer should sound.
+};
+
+/// @brief The clock settings kept across resets by `SettingsStore` (`settings_store.h`).
+///
+/// The time itself isn't kept: without a battery-backed clock, it is unknown after a power loss.
+struct ClockSettings
+{
+    uint32_t alarm;            ///< Alarm time, in the binary format of `set_alarm()`
+    int32_t alarm_date;        ///< Single date the alarm rings on, or -1
+    uint8_t alarm_days;        ///< Days of the week the alarm rings on
+    uint8_t time_zone;         ///< `TimeZoneId`
+    uint8_t snooze_minutes;    ///< Snooze repeat interval
+    uint8_t countdown_minutes; ///< Countdown duration
+};
+
 class Clock
 {
 private:
@@ -60,15 +158,61 @@ private:
     uint32_t *time_to_set = nullptr;                            ///< A pointer of the current time to set. Points to either clock or alarm
     uint32_t temp_time = 0;                                     ///< The variable on display that is being modified in the set menu.
                                                                 /// This variable isn't stored unless the OK button is pressed. Pressing the menu button cancels the variable storage.
-    uint32_t timestamp = 0;                                     ///< timestamp in milliseconds. Used for incrementing the time counter and advancing the clock.
+    uint32_t timestamp = 0;                                     ///< timestamp in milliseconds. Local time of day. Used for incrementing the time counter and advancing the clock.
+    int64_t epoch_ms = 0;                                       ///< UTC time in milliseconds since 1970-01-01. The timebase of the clock.
+    int32_t day = 0;                                            ///< Local date, in days since 1970-01-01.
+    CivilDate date = {1970, 1, 1};                              ///< Local date, as year, month and day.
+    uint8_t weekday = 4;                                        ///< Local day of the week (0 = Sunday). 1970-01-01 was a Thursday.
+    const TimeZone *zone = &TIME_ZONES[TZ_UTC];                 ///< Time zone of the local time.
+    int32_t offset_ms = 0;                                      ///< Current offset of the local time from UTC, including DST.
+    int64_t next_offset_change = INT64_MAX;                     ///< UTC time of the next DST change.
+    uint8_t alarm_days = EVERY_DAY;                             ///< Days of the week the alarm rings on. Bit n is weekday n (0 = Sunday).
+    int32_t alarm_date = -1;                                    ///< Single date the alarm rings on (days since 1970-01-01), or -1 to use `alarm_days`.
     uint8_t state = STATE_CLOCK;                                ///< Current state of the clock
     uint8_t set_digit = DIGITS_LEFT;                            ///< The current digit in focus in the SET or Alarm Menu.
-    bool alarm_enabled = 0;                                     ///< The state of the alarm enable switch.
+    std::atomic<bool> alarm_enabled{false};                     ///< The state of the alarm enable switch. Written by the switch ISR, which may run on another core than the timekeeping.
     uint8_t blink_state = POINT;                                ///< Blinking state: middle point (colon), left two digits, right two digits
     uint8_t display_state = DIGITS_LEFT | POINT | DIGITS_RIGHT; ///< Display state: middle point (colon), left two digits, right two digits
 
-    uint8_t alarm_off_counter; ///< Counter for Alarm off display message
-    uint8_t alarm_counter;     ///< Counter for Alarm sound and display
+    bool colon_blink = true;   ///< Whether the middle colon blinks in the clock state.
+
+    TimerWheel timers;                              ///< Timer wheel driven by the clock tick
+    uint32_t wheel_ms = 0;                          ///< Milliseconds accumulated towards the next timer wheel tick
+    WheelTimer ring_timer;                          ///< Stops the alarm sound and display
+    WheelTimer message_timer;                       ///< Ends the display of a message ("OFF")
+    WheelTimer menu_timer;                          ///< Returns to the clock after menu inactivity
+    WheelTimer snooze_timer;                        ///< Rings the alarm again after a snooze
+    uint8_t snooze_minutes = DEFAULT_SNOOZE_MINUTES; ///< Snooze repeat interval. 0 disables the snooze.
+    uint32_t ring_time = 0;                         ///< Time shown while ringing: the alarm time, or 00:00 for the countdown.
+    bool ring_snoozable = true;                     ///< Whether the menu button snoozes the ringing alarm. Not at the end of a countdown.
+
+    int64_t press_us = 0;                     ///< Monotonic time of the button press being handled, in microseconds.
+    uint8_t divider = 1;                      ///< Timer interrupts per 0.5 second tick. `FAST_TICK_DIVIDER` while a running stopwatch or countdown is shown.
+    uint8_t sub_tick = 0;                     ///< Timer interrupts since the last 0.5 second tick.
+    bool stopwatch_running = false;           ///< Whether the stopwatch is counting.
+    int64_t stopwatch_us = 0;                 ///< Stopwatch: start time while running (shifted by the time counted before), counted time while stopped.
+    int64_t lap_us = -1;                      ///< Lap time frozen on the display, or -1.
+    bool countdown_running = false;           ///< Whether the countdown is counting.
+    int64_t countdown_us = DEFAULT_COUNTDOWN_MINUTES * 60000000LL; ///< Countdown: end time while running, time left while paused.
+    uint8_t countdown_minutes = DEFAULT_COUNTDOWN_MINUTES;          ///< Countdown duration, set with the `+` and `-` buttons.
+
+    int64_t last_tick_us = 0; ///< Monotonic time (microseconds) the timestamp was last advanced to.
+    std::atomic<uint32_t> time_seq{0}; ///< Incremented before and after each time update, so readers on other cores can detect torn reads.
+    SpscQueue<int64_t, 4> adjustments;         ///< Time corrections (microseconds) requested by `adjust()`, applied on the next tick.
+    int32_t slew_us = 0;                       ///< Part of the time correction still to be slewed.
+    int32_t carry_us = 0;                      ///< Slewed time below the millisecond resolution of `epoch_ms`, 0 to 999.
+    std::atomic<bool> settings_changed{false}; ///< Set when a setting of `ClockSettings` changes, until `take_settings_changed()`.
+    int8_t last_key = -1;     ///< Key pressed at the last key scan, or -1.
+    int64_t start_us = 0;     ///< Monotonic time (microseconds) the clock started running. Used for the wake-up rate.
+    uint32_t wakeups = 0;     ///< Number of CPU wake-ups since the clock started running.
+
+#if CLOCK_DUAL_CORE || CLOCK_LOW_POWER
+    SpscQueue<ButtonEvent, 8> buttons;   ///< Button presses handed from the button ISRs to the timekeeping task.
+#endif
+#if CLOCK_DUAL_CORE
+    TripleBuffer<Frame> frames;          ///< Frames handed from the timekeeping core to the render core.
+    std::atomic<uint32_t> busy_us[2]{};  ///< Busy time of the clock tasks on each core (microseconds, wrapping).
+#endif
 
 public:
     // Constructor
@@ -81,24 +225,80 @@ public:
     void set_time(uint8_t hours, uint8_t minutes, uint8_t seconds);
     void set_alarm(uint8_t hours, uint8_t minutes);
 
+    // Calendar functions
+    void set_date(int16_t year, uint8_t month, uint8_t day);
+    void set_time_zone(TimeZoneId id);
+    void set_epoch(int64_t ms);
+    int64_t utc_us(int64_t mono_us);
+    void adjust(int64_t offset_us);
+    void set_alarm_days(uint8_t weekdays);
+    void set_alarm_date(int16_t year, uint8_t month, uint8_t day);
+
     // Alarm functions
     void check_alarm();
+    void set_snooze(uint8_t minutes);
+    void start_ringing(bool snoozable = true);
+    void check_countdown();
+
+    // Stopwatch and countdown functions
+    bool fast_refresh();
+    void update_divider();
+    int64_t stopwatch_elapsed(int64_t now_us);
+    int64_t countdown_left(int64_t now_us);
+    void snooze();
+
+    // Timer wheel callbacks
+    void ring_timeout();
+    void snooze_timeout();
+    void message_timeout();
+    void menu_timeout();
 
     // Clock functions
     void show();
+    void compose(Frame &frame);       // Composes the next frame to show.
+    void render(const Frame &frame);  // Sends a frame to the display and sequences the buzzer.
+    bool buzzing();                   // Whether the buzzer plays, from the first ringing frame until the ring stops.
+    uint8_t current_state();          // The state of the clock, one of `ClockState`.
+    void show_first_frame(); // Clears the display and shows the first frame in one transfer.
     void run();
+    void tick(); // Advances the time by one 0.5 second tick, checks the alarm and refreshes the display.
 
     // TODO: Add other public variables/functions here
     void setup_timer();                // Attaches the class member timer to the interrupt service routine to run the interrupt every 0.5 seconds.
     void update_time();                // Increments the timestamp by 0.5 seconds for every call.
+    void advance_time(uint32_t ms, int64_t mono_us); // Increments the timestamp by an arbitrary number of milliseconds.
+    void localize();                   // Recomputes the local date and time of day from the UTC epoch time.
+    void pack_time();                  // Stores the local time of day in the binary `time` variable.
     void set_temp_time(int8_t offset); // When in the set menus (for the alarm and the clock), this function modifies the time on the display by an offset.
     void commit_temp_time();
 
+    // Settings kept across resets
+    ClockSettings settings();
+    void restore(const ClockSettings &settings);
+    bool take_settings_changed();
+
+    void press(ButtonType button);             // Entry point of the button ISRs.
+    void scan_keys(uint8_t code);              // Turns a TM1637 key-scan code into button presses.
+    void handleButtonPress(ButtonType button, int64_t time_us); // Runs the state machine for a button press.
     void handleButtonMenuPress();
     void handleButtonOkPress();
     void handleButtonPlusPress();
     void handleButtonMinusPress();
     void handleSwitchAlarmChange(bool alarm_pin);
+
+    // Low-power functions
+    void set_colon_blink(bool enabled);  // Enables or disables the blinking of the middle colon in the clock state.
+    uint32_t next_deadline_ms();         // Milliseconds until the display or the alarm must change.
+    void sleep_until_next_deadline();    // Sleeps the CPU until the next deadline or a button wake-up.
+    uint32_t wakeups_per_hour();         // Average CPU wake-ups per hour since the clock started running.
+
+#if CLOCK_DUAL_CORE
+    // Dual-core task bodies
+    void start_tasks();
+    void timekeeping_loop();
+    void render_loop();
+    void console_loop();
+#endif
 };
 
 extern Clock clk;
@@ -0,0 +1,138 @@
+/// @file config_bundle.cpp
+/// Implementation of the ConfigBundle class.
+///
+/// This file contains the loader of the configuration bundle: the partition mapping and the
+/// checks of the header and the checksum.
+#include <cstddef>
+#include <cstring>
+#include "esp_partition.h"
+#include "config_bundle.h"
+
+static_assert(sizeof(BundleHeader) == 24, "BundleHeader must match tools/mkbundle.py");
+static_assert(sizeof(BundleSection) == 8, "BundleSection must match tools/mkbundle.py");
+static_assert(sizeof(BundleAlarm) == 4 && sizeof(BundleTone) == 4 && sizeof(Note) == 4,
+              "Bundle records must match tools/mkbundle.py");
+
+/// @brief Resident part of the bundle in use. Read by the timer ISR.
+alignas(4) static uint8_t resident[BUNDLE_RESIDENT_MAX];
+
+ConfigBundle config_bundle;
+
+/// @brief Record size and residency of each section, indexed by `BundleSectionId`.
+static const struct
+{
+    uint16_t record_size;
+    uint16_t min_count;
+    bool resident;
+} SECTIONS[SECTION_COUNT] = {
+    {sizeof(BundleAlarm), 0, true},
+    {sizeof(BundleTone), 1, true},
+    {sizeof(BundleLabel), LABEL_COUNT, true},
+    {sizeof(Note), 1, false},
+};
+
+/// @brief CRC-32 as computed by zlib (reflected, polynomial 0xedb88320), four bits at a time.
+/// @param data The bytes.
+/// @param length Number of bytes.
+/// @return The CRC.
+static uint32_t crc32(const uint8_t *data, uint32_t length)
+{
+    static const uint32_t NIBBLES[16] = {
+        0x00000000, 0x1db71064, 0x3b6e20c8, 0x26d930ac, 0x76dc4190, 0x6b6b51f4, 0x4db26158, 0x5005713c,
+        0xedb88320, 0xf00f9344, 0xd6d6a3e8, 0xcb61b38c, 0x9b64c2b0, 0x86d3d2d4, 0xa00ae278, 0xbdbdf21c,
+    };
+    uint32_t crc = 0xffffffff;
+    while (length--)
+    {
+        crc ^= *data++;
+        crc = (crc >> 4) ^ NIBBLES[crc & 0x0f];
+        crc = (crc >> 4) ^ NIBBLES[crc & 0x0f];
+    }
+    return ~crc;
+}
+
+/// @brief Start with the built-in bundle.
+ConfigBundle::ConfigBundle()
+{
+    attach(DEFAULT_BUNDLE, DEFAULT_BUNDLE_SIZE);
+}
+
+/// @brief Use the bundle of the `config` partition, if it is valid.
+///
+/// The partition stays mapped while the bundle is in use. Called once from `setup()`, before the timer starts.
+/// @return `true` if the partition bundle is used, `false` if the built-in bundle is kept.
+bool ConfigBundle::load()
+{
+    const esp_partition_t *partition =
+        esp_partition_find_first(ESP_PARTITION_TYPE_DATA, (esp_partition_subtype_t)BUNDLE_PARTITION_SUBTYPE, "config");
+    if (!partition)
+    {
+        return false;
+    }
+
+    const void *mapped;
+    spi_flash_mmap_handle_t handle;
+    if (esp_partition_mmap(partition, 0, partition->size, SPI_FLASH_MMAP_DATA, &mapped, &handle) != ESP_OK)
+    {
+        return false;
+    }
+    if (!attach((const uint8_t *)mapped, partition->size))
+    {
+        spi_flash_munmap(handle);
+        return false;
+    }
+    return true;
+}
+
+/// @brief Use a bundle in memory, if it is valid. The bundle is kept as it is, and must stay in place.
+///
+/// Only checks the header, the section table and the checksum. The contents of the records are
+/// checked by `tools/mkbundle.py` when the bundle is built.
+/// @param bundle The bundle.
+/// @param capacity Bytes available at `bundle`, e.g. the partition size.
+/// @return `true` if the bundle is valid and now in use. Otherwise the bundle in use is kept.
+bool ConfigBundle::attach(const uint8_t *bundle, uint32_t capacity)
+{
+    const BundleHeader *header = (const BundleHeader *)bundle;
+    if (capacity < sizeof(BundleHeader) || header->magic != BUNDLE_MAGIC || header->version_major != BUNDLE_VERSION_MAJOR)
+    {
+        return false;
+    }
+    uint32_t resident_end = header->header_size + header->resident_size;
+    if (header->size > capacity || header->header_size < sizeof(BundleHeader) + header->section_count * sizeof(BundleSection) ||
+        header->header_size % 4 || header->resident_size > BUNDLE_RESIDENT_MAX || resident_end > header->size ||
+        header->section_count < SECTION_COUNT)
+    {
+        return false;
+    }
+    const uint32_t checked = offsetof(BundleHeader, crc32) + sizeof(header->crc32);
+    if (crc32(bundle + checked, header->size - checked) != header->crc32)
+    {
+        return false;
+    }
+
+    const BundleSection *sections = (const BundleSection *)(bundle + sizeof(BundleHeader));
+    for (uint8_t id = 0; id < SECTION_COUNT; id++) // Sections added by later minor versions are ignored
+    {
+        const BundleSection &section = sections[id];
+        uint64_t end = (uint64_t)section.offset + (uint32_t)section.count * section.record_size; // 64 bits: can't wrap
+        if (section.record_size != SECTIONS[id].record_size || section.count < SECTIONS[id].min_count || section.offset % 4 ||
+            section.offset < header->header_size || end > (SECTIONS[id].resident ? resident_end : header->size))
+        {
+            return false;
+        }
+    }
+
+    memcpy(resident, bundle + header->header_size, header->resident_size);
+    const uint16_t base = header->header_size; // Resident sections are read from the RAM copy
+    _alarms = (const BundleAlarm *)(resident + (sections[SECTION_ALARMS].offset - base));
+    _alarm_count = sections[SECTION_ALARMS].count;
+    _tones = (const BundleTone *)(resident + (sections[SECTION_TONES].offset - base));
+    _tone_count = sections[SECTION_TONES].count;
+    _labels = (const BundleLabel *)(resident + (sections[SECTION_LABELS].offset - base));
+    _melody = (const Note *)(bundle + sections[SECTION_MELODY].offset);
+    _melody_length = sections[SECTION_MELODY].count;
+    _version_minor = header->version_minor;
+    _builtin = bundle == DEFAULT_BUNDLE;
+    return true;
+}
@@ -0,0 +1,137 @@
+/// @file config_bundle.h
+/// Binary configuration bundle: preset alarms, alarm melodies and display labels.
+///
+/// The bundle is built on a computer by `tools/mkbundle.py` and written to the `config` data
+/// partition (`partitions.csv`), so it can be changed without rebuilding the firmware. It is
+/// read in place: `load()` maps the partition, checks the header and the checksum, and the
+/// accessors return pointers into the bundle. There is no parsing into runtime structures.
+///
+/// Layout (little-endian, all offsets from the start of the bundle and 4-byte aligned):
+/// ```
+/// BundleHeader | BundleSection[section_count] | resident sections | mapped sections
+/// ```
+/// The resident sections (alarms, tones, labels) are read by the timer ISR, which is kept able to
+/// run while the flash cache is disabled. `load()` copies them as they are into RAM (`BUNDLE_RESIDENT_MAX`
+/// bytes at most). The other sections (the PCM melody) are only read by tasks, from flash.
+#ifndef CONFIG_BUNDLE_H
+#define CONFIG_BUNDLE_H
+
+#include <cstdint>
+#include "esp_attr.h"
+#include "audio_synth.h"
+
+#define BUNDLE_MAGIC 0x47464341      ///< "ACFG"
+#define BUNDLE_VERSION_MAJOR 1       ///< Incompatible layout changes. Bundles of another major version are rejected.
+#define BUNDLE_VERSION_MINOR 0       ///< Compatible additions, e.g. new sections, which older firmware ignores.
+#define BUNDLE_RESIDENT_MAX 512      ///< Largest resident part, in bytes
+#define BUNDLE_LABEL_DIGITS 8        ///< Bytes per label. The first `TM1637_DIGITS` are shown.
+#define BUNDLE_PARTITION_SUBTYPE 0x40 ///< Subtype of the `config` data partition (custom range 0x40-0xfe)
+
+/// @brief Bundle header. Followed by `section_count` section entries.
+struct BundleHeader
+{
+    uint32_t magic;         ///< `BUNDLE_MAGIC`
+    uint8_t version_major;  ///< `BUNDLE_VERSION_MAJOR`
+    uint8_t version_minor;  ///< `BUNDLE_VERSION_MINOR` of the tool that built the bundle
+    uint16_t header_size;   ///< Size of the header and the section table: offset of the resident part
+    uint32_t size;          ///< Size of the whole bundle
+    uint32_t crc32;         ///< CRC-32 (as zlib) of the bytes after this field, up to `size`
+    uint32_t resident_size; ///< Size of the resident part, which follows the header
+    uint16_t section_count; ///< Entries in the section table
+    uint16_t reserved;
+};
+
+/// @brief Entry of the section table, indexed by `BundleSectionId`.
+struct BundleSection
+{
+    uint32_t offset;      ///< Offset of the first record
+    uint16_t count;       ///< Number of records
+    uint16_t record_size; ///< Size of a record. Must match the structure of the section.
+};
+
+/// @brief Sections of the bundle.
+enum BundleSectionId
+{
+    SECTION_ALARMS = 0, ///< `BundleAlarm` records. Resident.
+    SECTION_TONES = 1,  ///< `BundleTone` records: the `tone()` melody. Resident.
+    SECTION_LABELS = 2, ///< `BundleLabel` records, indexed by `LabelId`. Resident.
+    SECTION_MELODY = 3, ///< `Note` records: the PCM melody (`audio_synth.h`). Mapped.
+    SECTION_COUNT
+};
+
+/// @brief A preset alarm. Rings like the alarm set with the menu, when the alarm switch is on.
+struct BundleAlarm
+{
+    uint8_t hour;   ///< 0 to 23
+    uint8_t minute; ///< 0 to 59
+    uint8_t days;   ///< Days of the week it rings on. Bit n is weekday n (0 = Sunday).
+    uint8_t flags;  ///< `ALARM_PRESET_ENABLED`
+};
+
+#define ALARM_PRESET_ENABLED 0x01 ///< The preset rings. Cleared to keep a preset in the bundle without using it.
+
+/// @brief A note of the `tone()` alarm melody.
+struct BundleTone
+{
+    uint16_t hz; ///< Frequency. 0 for a rest.
+    uint16_t ms; ///< Duration
+};
+
+/// @brief A label, encoded as 7-segment data (see `TM1637::coding()`). Unused digits are 0.
+struct BundleLabel
+{
+    uint8_t segments[BUNDLE_LABEL_DIGITS];
+};
+
+/// @brief Labels shown by the menus and messages. Index into the labels section.
+enum LabelId
+{
+    LABEL_SET = 0,       ///< Menu: set the clock
+    LABEL_ALARM = 1,     ///< Menu: set the alarm
+    LABEL_STOPWATCH = 2, ///< Menu: stopwatch
+    LABEL_COUNTDOWN = 3, ///< Menu: countdown
+    LABEL_OFF = 4,       ///< Message: the alarm is off
+    LABEL_COUNT
+};
+
+/// @brief The bundle built into the firmware, used when the partition has no valid bundle.
+///        Generated by `tools/mkbundle.py` into default_bundle.cpp.
+extern const uint8_t DEFAULT_BUNDLE[];
+extern const uint32_t DEFAULT_BUNDLE_SIZE;
+
+/// @brief The configuration bundle in use.
+///
+/// Holds the built-in bundle until `load()` finds a valid one in the partition. The accessors
+/// are in IRAM, as the timer ISR calls them.
+class ConfigBundle
+{
+public:
+    ConfigBundle();
+    bool load();
+    bool attach(const uint8_t *bundle, uint32_t capacity);
+
+    IRAM_ATTR const BundleAlarm *alarms() const { return _alarms; }
+    IRAM_ATTR uint16_t alarm_count() const { return _alarm_count; }
+    IRAM_ATTR const BundleTone *tones() const { return _tones; }
+    IRAM_ATTR uint16_t tone_count() const { return _tone_count; }
+    IRAM_ATTR const uint8_t *label(LabelId id) const { return _labels[id].segments; }
+    const Note *melody() const { return _melody; }
+    uint16_t melody_length() const { return _melody_length; }
+    uint8_t version_minor() const { return _version_minor; }
+    bool builtin() const { return _builtin; }
+
+private:
+    const BundleAlarm *_alarms = nullptr;
+    uint16_t _alarm_count = 0;
+    const BundleTone *_tones = nullptr;
+    uint16_t _tone_count = 0;
+    const BundleLabel *_labels = nullptr;
+    const Note *_melody = nullptr;
+    uint16_t _melody_length = 0;
+    uint8_t _version_minor = 0;
+    bool _builtin = true;
+};
+
+extern ConfigBundle config_bundle;
+
+#endif
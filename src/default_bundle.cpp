@@ -0,0 +1,18 @@
+/// @file default_bundle.cpp
+/// Configuration bundle built into the firmware, used when the `config` partition has no valid bundle.
+///
+/// Generated by `tools/mkbundle.py cpp tools/bundle.json`, don't edit by hand.
+#include "config_bundle.h"
+
+alignas(4) const uint8_t DEFAULT_BUNDLE[] = {
+    0x41, 0x43, 0x46, 0x47, 0x01, 0x00, 0x38, 0x00, 0x88, 0x00, 0x00, 0x00, 0xdb, 0x2c, 0x7f, 0xf2,
+    0x34, 0x00, 0x00, 0x00, 0x04, 0x00, 0x00, 0x00, 0x38, 0x00, 0x00, 0x00, 0x01, 0x00, 0x04, 0x00,
+    0x3c, 0x00, 0x00, 0x00, 0x02, 0x00, 0x04, 0x00, 0x44, 0x00, 0x00, 0x00, 0x05, 0x00, 0x08, 0x00,
+    0x6c, 0x00, 0x00, 0x00, 0x07, 0x00, 0x04, 0x00, 0x07, 0x00, 0x3e, 0x00, 0x20, 0x03, 0xfa, 0x00,
+    0x20, 0x03, 0xfa, 0x00, 0x6d, 0x79, 0x78, 0x00, 0x00, 0x00, 0x00, 0x00, 0x77, 0x38, 0x00, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x6d, 0x78, 0x73, 0x00, 0x00, 0x00, 0x00, 0x00, 0x39, 0x54, 0x78, 0x00,
+    0x00, 0x00, 0x00, 0x00, 0x5c, 0x71, 0x71, 0x00, 0x00, 0x00, 0x00, 0x00, 0x48, 0x01, 0x78, 0x00,
+    0x4c, 0x01, 0x78, 0x00, 0x4f, 0x01, 0x78, 0x00, 0x54, 0x01, 0xf0, 0x00, 0x54, 0x02, 0xa0, 0x00,
+    0x5b, 0x02, 0x80, 0x02, 0x00, 0x00, 0xc8, 0x00,
+};
+const uint32_t DEFAULT_BUNDLE_SIZE = sizeof(DEFAULT_BUNDLE);
@@ -0,0 +1,103 @@
+/// @file handoff.h
+/// Lock-free handoff structures between the two cores.
+///
+/// Both structures have exactly one producer and one consumer. They only use atomic
+/// loads, stores and exchanges on 32-bit words, so neither side ever waits for the other.
+/// The producer side is called from the timer and button ISRs, and `SpscQueue::pop()` from the
+/// timer ISR, so they are in IRAM.
+#ifndef HANDOFF_H
+#define HANDOFF_H
+
+#include <cstdint>
+#include <atomic>
+#include "esp_attr.h"
+
+/// @brief Triple buffer. Hands the latest value from one producer to one consumer.
+///
+/// The producer fills `write_slot()` and calls `publish()`. The consumer calls `fetch()`
+/// and reads `read_slot()`. Values that are published faster than they are fetched
+/// are overwritten; the consumer always gets the newest one.
+template <typename T>
+class TripleBuffer
+{
+private:
+    static const uint32_t INDEX = 0b011; ///< Index bits of the middle buffer
+    static const uint32_t FRESH = 0b100; ///< Set when the middle buffer holds a value not fetched yet
+
+    T buffers[3];
+    std::atomic<uint32_t> middle{1}; ///< Index of the buffer between producer and consumer, plus the `FRESH` flag.
+    uint32_t write_index = 0;        ///< Buffer owned by the producer
+    uint32_t read_index = 2;         ///< Buffer owned by the consumer
+
+public:
+    /// @brief The buffer the producer writes to. Only valid until the next `publish()`.
+    IRAM_ATTR T &write_slot() { return buffers[write_index]; }
+
+    /// @brief Publish the write slot, and take the middle buffer as the next write slot.
+    IRAM_ATTR void publish()
+    {
+        write_index = middle.exchange(write_index | FRESH, std::memory_order_acq_rel) & INDEX;
+    }
+
+    /// @brief Take the latest published value, if there is one.
+    /// @return `true` if `read_slot()` now holds a value that wasn't fetched before.
+    bool fetch()
+    {
+        if (!(middle.load(std::memory_order_acquire) & FRESH))
+        {
+            return false;
+        }
+        read_index = middle.exchange(read_index, std::memory_order_acq_rel) & INDEX;
+        return true;
+    }
+
+    /// @brief The buffer the consumer reads from. Only valid until the next `fetch()`.
+    const T &read_slot() const { return buffers[read_index]; }
+};
+
+/// @brief Bounded single-producer single-consumer queue.
+///
+/// Interrupt service routines of the same priority don't preempt each other, so the
+/// ISRs of one core count as a single producer.
+/// @tparam N Capacity. Must be a power of two.
+template <typename T, uint32_t N>
+class SpscQueue
+{
+private:
+    static_assert((N & (N - 1)) == 0, "SpscQueue capacity must be a power of two");
+
+    T items[N];
+    std::atomic<uint32_t> head{0}; ///< Next item to pop. Written by the consumer.
+    std::atomic<uint32_t> tail{0}; ///< Next free slot. Written by the producer.
+
+public:
+    /// @brief Push an item. Called by the producer only.
+    /// @return `false` if the queue is full and the item was dropped.
+    IRAM_ATTR bool push(const T &item)
+    {
+        uint32_t t = tail.load(std::memory_order_relaxed);
+        if (t - head.load(std::memory_order_acquire) == N)
+        {
+            return false;
+        }
+        items[t & (N - 1)] = item;
+        tail.store(t + 1, std::memory_order_release);
+        return true;
+    }
+
+    /// @brief Pop an item. Called by the consumer only.
+    /// @return `false` if the queue is empty.
+    IRAM_ATTR bool pop(T &item)
+    {
+        uint32_t h = head.load(std::memory_order_relaxed);
+        if (h == tail.load(std::memory_order_acquire))
+        {
+            return false;
+        }
+        item = items[h & (N - 1)];
+        head.store(h + 1, std::memory_order_release);
+        return true;
+    }
+};
+
+#endif
@@ -0,0 +1,310 @@
+/// @file sample_bank.cpp
+/// Sample bank of the alarm synthesizer.
+///
+/// Generated by `tools/gen_samples.py`, don't edit the tables by hand.
+/// The tables are `const`, so they stay in flash and are read in place.
+#include "sample_bank.h"
+
+static const int8_t WAVE_SINE[256] = {
+    0, 3, 6, 9, 12, 16, 19, 22, 25, 28, 31, 34, 37, 40, 43, 46,
+    49, 51, 54, 57, 60, 63, 65, 68, 71, 73, 76, 78, 81, 83, 85, 88,
+    90, 92, 94, 96, 98, 100, 102, 104, 106, 107, 109, 111, 112, 113, 115, 116,
+    117, 118, 120, 121, 122, 122, 123, 124, 125, 125, 126, 126, 126, 127, 127, 127,
+    127, 127, 127, 127, 126, 126, 126, 125, 125, 124, 123, 122, 122, 121, 120, 118,
+    117, 116, 115, 113, 112, 111, 109, 107, 106, 104, 102, 100, 98, 96, 94, 92,
+    90, 88, 85, 83, 81, 78, 76, 73, 71, 68, 65, 63, 60, 57, 54, 51,
+    49, 46, 43, 40, 37, 34, 31, 28, 25, 22, 19, 16, 12, 9, 6, 3,
+    0, -3, -6, -9, -12, -16, -19, -22, -25, -28, -31, -34, -37, -40, -43, -46,
+    -49, -51, -54, -57, -60, -63, -65, -68, -71, -73, -76, -78, -81, -83, -85, -88,
+    -90, -92, -94, -96, -98, -100, -102, -104, -106, -107, -109, -111, -112, -113, -115, -116,
+    -117, -118, -120, -121, -122, -122, -123, -124, -125, -125, -126, -126, -126, -127, -127, -127,
+    -127, -127, -127, -127, -126, -126, -126, -125, -125, -124, -123, -122, -122, -121, -120, -118,
+    -117, -116, -115, -113, -112, -111, -109, -107, -106, -104, -102, -100, -98, -96, -94, -92,
+    -90, -88, -85, -83, -81, -78, -76, -73, -71, -68, -65, -63, -60, -57, -54, -51,
+    -49, -46, -43, -40, -37, -34, -31, -28, -25, -22, -19, -16, -12, -9, -6, -3,
+};
+
+static const int8_t WAVE_ORGAN[256] = {
+    0, 9, 18, 27, 35, 44, 52, 59, 67, 74, 81, 87, 93, 98, 103, 108,
+    111, 115, 118, 120, 122, 124, 125, 126, 127, 127, 127, 127, 126, 125, 125, 124,
+    122, 121, 120, 118, 117, 116, 114, 113, 111, 109, 108, 106, 105, 103, 101, 100,
+    98, 96, 94, 92, 90, 88, 86, 84, 81, 79, 77, 75, 72, 70, 68, 66,
+    64, 62, 60, 59, 57, 56, 54, 53, 52, 52, 51, 50, 50, 50, 50, 50,
+    50, 50, 51, 51, 51, 51, 52, 52, 52, 51, 51, 51, 50, 49, 48, 47,
+    46, 44, 42, 40, 38, 36, 34, 31, 29, 26, 23, 21, 18, 16, 13, 11,
+    9, 7, 5, 4, 3, 1, 0, 0, -1, -1, -1, -1, -1, -1, -1, 0,
+    0, 0, 1, 1, 1, 1, 1, 1, 1, 0, 0, -1, -3, -4, -5, -7,
+    -9, -11, -13, -16, -18, -21, -23, -26, -29, -31, -34, -36, -38, -40, -42, -44,
+    -46, -47, -48, -49, -50, -51, -51, -51, -52, -52, -52, -51, -51, -51, -51, -50,
+    -50, -50, -50, -50, -50, -50, -51, -52, -52, -53, -54, -56, -57, -59, -60, -62,
+    -64, -66, -68, -70, -72, -75, -77, -79, -81, -84, -86, -88, -90, -92, -94, -96,
+    -98, -100, -101, -103, -105, -106, -108, -109, -111, -113, -114, -116, -117, -118, -120, -121,
+    -122, -124, -125, -125, -126, -127, -127, -127, -127, -126, -125, -124, -122, -120, -118, -115,
+    -111, -108, -103, -98, -93, -87, -81, -74, -67, -59, -52, -44, -35, -27, -18, -9,
+};
+
+static const int8_t PCM_CHIME[4096] = {
+    0, 2, 4, 5, 7, 3, 14, 14, -5, -11, -33, -28, -8, -18, -18, -16,
+    -5, 31, 64, 45, 27, 22, -3, 31, 3, -61, -64, -93, -49, 6, -10, -8,
+    13, 45, 93, 119, 42, 4, -5, -40, 6, -45, -107, -81, -75, -3, 49, 28,
+    21, 51, 70, 90, 84, -19, -44, -43, -64, -16, -67, -98, -45, -13, 55, 85,
+    49, 30, 61, 60, 52, 24, -83, -79, -60, -62, -12, -55, -57, 10, 52, 94,
+    93, 41, 12, 44, 21, -1, -36, -125, -82, -44, -32, 14, -22, -5, 62, 93,
+    95, 67, 2, -25, 13, -25, -46, -72, -127, -47, -1, 15, 46, 14, 34, 89,
+    96, 57, 16, -49, -61, -12, -56, -63, -72, -89, 13, 53, 56, 64, 32, 45,
+    81, 61, -6, -41, -91, -75, -16, -58, -48, -40, -28, 74, 91, 70, 54, 23,
+    26, 47, 6, -68, -79, -102, -56, 6, -35, -11, 6, 32, 111, 97, 48, 17,
+    -6, -11, 5, -44, -106, -80, -76, -9, 44, -1, 28, 44, 66, 110, 65, -3,
+    -32, -39, -43, -23, -70, -104, -44, -23, 49, 78, 24, 48, 57, 65, 72, 9,
+    -63, -71, -56, -54, -24, -64, -68, 14, 36, 92, 88, 24, 39, 42, 33, 14,
+    -49, -106, -80, -44, -36, 1, -34, -14, 70, 76, 102, 65, -3, 8, 9, -11,
+    -39, -84, -114, -51, -5, 1, 36, 1, 33, 101, 80, 73, 14, -45, -30, -21,
+    -46, -67, -84, -85, 6, 44, 39, 62, 21, 55, 96, 49, 16, -44, -82, -52,
+    -30, -55, -59, -50, -29, 68, 82, 57, 63, 17, 45, 59, -4, -45, -86, -92,
+    -46, -13, -39, -25, 1, 28, 112, 88, 43, 35, -10, 15, 11, -54, -87, -92,
+    -69, -11, 24, -8, 17, 45, 64, 119, 58, 2, -10, -43, -18, -28, -81, -93,
+    -60, -20, 39, 61, 17, 47, 63, 65, 88, 1, -50, -51, -63, -35, -40, -75,
+    -63, -2, 37, 81, 78, 20, 50, 51, 36, 32, -60, -90, -68, -56, -25, -23,
+    -43, -13, 59, 76, 95, 64, -2, 29, 16, -8, -25, -100, -98, -51, -21, 4,
+    11, -3, 35, 98, 81, 73, 20, -41, -4, -21, -44, -59, -104, -70, -4, 28,
+    37, 42, 25, 60, 101, 49, 23, -36, -77, -28, -42, -57, -60, -71, -17, 54,
+    69, 55, 53, 27, 55, 69, -6, -34, -80, -91, -29, -35, -42, -32, -17, 39,
+    98, 82, 45, 37, 3, 26, 20, -61, -74, -94, -71, -2, -6, -10, 9, 34,
+    76, 109, 59, 7, 1, -32, -7, -24, -93, -80, -71, -23, 40, 31, 20, 41,
+    63, 78, 83, 7, -42, -36, -59, -27, -45, -92, -52, -19, 34, 77, 54, 31,
+    50, 58, 48, 32, -54, -82, -55, -62, -22, -37, -60, -3, 40, 78, 91, 50,
+    15, 34, 28, 0, -22, -99, -92, -44, -37, 5, -9, -14, 46, 81, 89, 71,
+    18, -21, 4, -12, -43, -57, -110, -66, -4, 7, 39, 22, 23, 74, 89, 62,
+    24, -30, -59, -21, -40, -63, -60, -84, -13, 47, 48, 61, 38, 36, 70, 64,
+    8, -32, -72, -80, -25, -43, -52, -34, -33, 46, 88, 67, 56, 28, 21, 40,
+    18, -50, -73, -88, -69, -3, -23, -20, 8, 20, 88, 99, 53, 24, -1, -11,
+    1, -27, -89, -82, -70, -29, 36, 9, 16, 43, 53, 96, 75, 10, -24, -35,
+    -41, -27, -51, -95, -55, -24, 25, 74, 33, 37, 56, 56, 68, 24, -45, -67,
+    -55, -52, -30, -47, -69, -3, 31, 70, 91, 34, 32, 42, 30, 19, -31, -89,
+    -83, -47, -37, -8, -20, -24, 51, 72, 87, 75, 8, 4, 10, -7, -30, -68,
+    -103, -65, -11, -2, 27, 12, 17, 84, 81, 68, 31, -33, -32, -20, -38, -59,
+    -74, -81, -17, 39, 35, 55, 32, 38, 86, 56, 21, -25, -72, -56, -32, -46,
+    -57, -47, -34, 41, 80, 55, 60, 27, 31, 58, 9, -35, -70, -88, -54, -18,
+    -30, -29, -2, 18, 86, 94, 46, 37, 1, 4, 16, -38, -76, -85, -72, -24,
+    17, 0, 7, 40, 53, 100, 73, 8, -4, -34, -26, -20, -66, -86, -63, -27,
+    23, 56, 25, 34, 61, 57, 79, 24, -42, -46, -58, -41, -33, -64, -64, -15,
+    27, 65, 79, 31, 37, 53, 33, 33, -34, -84, -67, -56, -31, -20, -37, -21,
+    41, 70, 83, 72, 10, 17, 23, -7, -17, -76, -98, -56, -27, -2, 10, 0,
+    21, 80, 82, 68, 36, -29, -14, -12, -41, -49, -88, -77, -16, 20, 33, 40,
+    28, 45, 89, 59, 25, -16, -68, -38, -33, -54, -53, -65, -31, 37, 63, 54,
+    51, 32, 41, 66, 11, -29, -61, -88, -40, -29, -41, -30, -20, 23, 80, 83,
+    49, 37, 11, 16, 26, -40, -69, -81, -77, -15, -2, -11, 6, 26, 61, 96,
+    69, 15, 3, -22, -16, -13, -75, -81, -66, -37, 26, 33, 20, 35, 55, 69,
+    78, 26, -34, -34, -50, -36, -33, -79, -59, -23, 17, 66, 58, 33, 43, 55,
+    46, 35, -29, -76, -55, -57, -32, -26, -55, -15, 30, 63, 85, 57, 20, 27,
+    30, 4, -14, -74, -94, -48, -37, -6, -1, -16, 30, 71, 81, 72, 29, -13,
+    -3, -4, -37, -49, -91, -78, -13, 3, 29, 28, 18, 59, 82, 64, 31, -16,
+    -52, -29, -30, -58, -55, -74, -33, 36, 44, 55, 43, 31, 59, 63, 20, -22,
+    -58, -77, -36, -33, -51, -33, -32, 23, 78, 66, 56, 34, 19, 34, 23, -32,
+    -66, -78, -73, -17, -13, -24, 4, 15, 66, 95, 59, 29, 5, -10, -2, -17,
+    -71, -81, -66, -40, 22, 18, 9, 38, 46, 80, 79, 22, -16, -31, -38, -29,
+    -40, -82, -62, -26, 9, 62, 42, 30, 51, 51, 61, 36, -29, -60, -54, -50,
+    -34, -37, -63, -19, 25, 54, 85, 45, 27, 40, 30, 21, -16, -72, -82, -51,
+    -37, -15, -12, -25, 31, 66, 75, 77, 22, 1, 11, -4, -23, -55, -90, -72,
+    -20, -4, 18, 19, 11, 65, 80, 64, 41, -19, -33, -20, -32, -51, -65, -75,
+    -33, 28, 33, 46, 39, 30, 72, 62, 24, -11, -60, -59, -34, -40, -52, -45,
+    -35, 19, 71, 56, 55, 36, 23, 51, 21, -26, -57, -81, -60, -23, -24, -30,
+    -6, 12, 64, 92, 52, 36, 11, -1, 15, -23, -65, -77, -72, -34, 9, 5,
+    3, 32, 46, 82, 80, 19, -1, -24, -30, -17, -52, -79, -65, -34, 9, 48,
+    32, 27, 54, 54, 68, 39, -29, -42, -51, -45, -30, -53, -62, -25, 17, 52,
+    73, 41, 30, 49, 34, 31, -13, -72, -66, -55, -37, -19, -31, -25, 25, 61,
+    74, 73, 23, 11, 24, -2, -13, -56, -92, -61, -31, -8, 9, 3, 13, 63,
+    79, 65, 43, -14, -20, -8, -34, -44, -72, -79, -28, 12, 28, 37, 30, 36,
+    75, 65, 28, -3, -55, -45, -28, -48, -49, -58, -39, 21, 55, 53, 49, 36,
+    34, 58, 25, -21, -48, -80, -50, -26, -38, -30, -21, 10, 64, 80, 53, 37,
+    18, 10, 24, -22, -62, -71, -76, -29, -1, -10, 2, 21, 49, 84, 74, 25,
+    5, -14, -20, -10, -56, -78, -62, -44, 11, 33, 20, 29, 47, 61, 72, 39,
+    -21, -32, -42, -40, -28, -65, -63, -27, 6, 53, 59, 35, 37, 50, 45, 35,
+    -11, -65, -57, -52, -39, -22, -47, -26, 21, 51, 76, 62, 26, 22, 29, 9,
+    -10, -54, -89, -55, -36, -15, 2, -13, 17, 60, 73, 71, 38, -5, -7, -2,
+    -28, -44, -74, -81, -25, 0, 20, 30, 17, 45, 74, 64, 37, -4, -43, -34,
+    -25, -50, -52, -64, -44, 21, 40, 48, 46, 30, 48, 60, 29, -12, -46, -70,
+    -44, -28, -47, -35, -29, 5, 65, 66, 54, 39, 20, 28, 26, -18, -56, -70,
+    -72, -29, -9, -23, -1, 12, 48, 87, 63, 33, 11, -7, -4, -11, -55, -76,
+    -64, -45, 7, 21, 7, 31, 42, 66, 78, 33, -8, -25, -35, -30, -33, -68,
+    -66, -30, -1, 47, 47, 27, 45, 48, 54, 42, -13, -51, -52, -48, -37, -32,
+    -54, -30, 17, 42, 74, 54, 26, 36, 30, 20, -5, -56, -77, -54, -37, -20,
+    -9, -22, 14, 58, 67, 74, 35, 2, 9, -1, -18, -43, -78, -74, -29, -6,
+    10, 20, 10, 48, 75, 61, 45, -4, -31, -20, -27, -44, -58, -69, -43, 14,
+    31, 39, 41, 27, 58, 64, 29, -1, -46, -58, -36, -35, -47, -44, -35, 4,
+    58, 57, 50, 41, 22, 42, 29, -16, -46, -71, -63, -29, -21, -28, -11, 8,
+    46, 84, 58, 36, 18, -2, 11, -11, -54, -70, -69, -42, 0, 8, 1, 24,
+    41, 67, 80, 31, 1, -16, -30, -18, -39, -70, -64, -39, -2, 37, 36, 24,
+    45, 51, 59, 47, -14, -38, -44, -46, -30, -44, -58, -32, 8, 40, 65, 47,
+    27, 43, 36, 28, 1, -57, -65, -53, -40, -21, -25, -26, 12, 51, 66, 70,
+    34, 9, 21, 4, -12, -40, -81, -65, -34, -13, 6, 5, 9, 48, 73, 63,
+    47, 0, -21, -8, -27, -40, -60, -76, -38, 4, 23, 33, 30, 31, 62, 66,
+    33, 5, -40, -48, -27, -42, -47, -51, -43, 6, 46, 51, 47, 37, 30, 50,
+    34, -12, -38, -68, -57, -26, -34, -30, -20, 1, 49, 74, 56, 38, 22, 9,
+    20, -8, -53, -64, -71, -40, -4, -8, -1, 16, 39, 71, 74, 34, 8, -8,
+    -20, -11, -41, -72, -61, -46, -3, 29, 21, 25, 41, 54, 66, 46, -8, -30,
+    -36, -41, -28, -51, -63, -32, -3, 39, 57, 37, 34, 45, 43, 35, 2, -51,
+    -57, -48, -42, -23, -38, -32, 11, 41, 66, 64, 32, 21, 26, 13, -6, -39,
+    -78, -60, -36, -21, 0, -9, 7, 49, 66, 67, 45, 4, -8, -2, -21, -39,
+    -61, -77, -36, -3, 12, 28, 19, 34, 65, 63, 40, 6, -32, -36, -24, -41,
+    -50, -55, -49, 6, 36, 42, 45, 31, 40, 56, 34, -3, -35, -61, -49, -28,
+    -40, -36, -27, -5, 49, 64, 52, 41, 22, 23, 26, -7, -46, -62, -68, -38,
+    -10, -19, -7, 10, 34, 75, 66, 36, 16, -4, -6, -8, -41, -69, -62, -47,
+    -7, 20, 9, 23, 39, 54, 73, 42, 0, -20, -31, -30, -29, -56, -65, -35,
+    -8, 33, 48, 28, 38, 46, 48, 44, 0, -41, -49, -46, -38, -30, -45, -36,
+    7, 34, 63, 58, 28, 32, 31, 20, 2, -42, -70, -57, -38, -24, -10, -18,
+    3, 47, 61, 68, 44, 7, 7, 2, -14, -34, -66, -72, -38, -10, 5, 19,
+    12, 35, 68, 60, 46, 9, -26, -21, -23, -39, -51, -62, -48, 1, 28, 34,
+    40, 28, 46, 61, 34, 6, -32, -54, -39, -32, -42, -42, -35, -7, 44, 56,
+    47, 42, 24, 34, 33, -6, -36, -61, -63, -34, -20, -25, -14, 4, 33, 72,
+    62, 36, 23, 2, 7, -3, -43, -62, -65, -47, -9, 7, 2, 18, 36, 56,
+    74, 41, 5, -9, -26, -20, -30, -61, -62, -42, -10, 27, 36, 24, 38, 48,
+    52, 49, 1, -33, -39, -44, -32, -37, -53, -36, -1, 31, 57, 50, 28, 37,
+    37, 26, 9, -41, -62, -51, -42, -23, -21, -26, 2, 40, 59, 65, 42, 12,
+    18, 9, -9, -30, -68, -67, -38, -18, 1, 6, 7, 36, 65, 61, 48, 12,
+    -18, -10, -20, -37, -50, -69, -45, -4, 17, 29, 30, 28, 50, 63, 37, 11,
+    -27, -47, -29, -35, -45, -45, -44, -6, 36, 47, 45, 38, 29, 42, 37, -3,
+    -30, -57, -59, -30, -29, -31, -20, -5, 35, 66, 57, 39, 25, 11, 16, 1,
+    -41, -58, -65, -47, -10, -6, -4, 12, 31, 60, 71, 41, 12, -3, -17, -13,
+    -30, -63, -60, -46, -14, 23, 22, 22, 36, 48, 59, 49, 5, -25, -32, -39,
+    -29, -41, -59, -36, -8, 26, 51, 40, 32, 40, 41, 34, 11, -37, -54, -46,
+    -42, -25, -30, -34, 2, 32, 56, 62, 37, 21, 24, 15, -2, -28, -66, -63,
+    -37, -24, -4, -5, 0, 37, 59, 63, 48, 13, -6, -2, -15, -33, -51, -70,
+    -45, -8, 7, 24, 21, 27, 56, 61, 43, 14, -22, -35, -24, -34, -46, -49,
+    -49, -7, 30, 37, 43, 33, 34, 50, 38, 5, -26, -52, -51, -30, -34, -36,
+    -26, -11, 34, 59, 50, 42, 25, 20, 25, 2, -35, -55, -63, -44, -14, -16,
+    -10, 8, 26, 62, 67, 39, 20, 1, -6, -6, -31, -60, -60, -48, -17, 15,
+    11, 17, 35, 46, 65, 48, 8, -14, -27, -30, -27, -46, -61, -40, -13, 21,
+    44, 31, 33, 43, 43, 43, 11, -31, -45, -44, -38, -29, -38, -38, -2, 27,
+    52, 58, 32, 28, 30, 20, 7, -29, -61, -57, -39, -26, -12, -14, -4, 36,
+    55, 62, 49, 13, 6, 4, -11, -27, -54, -68, -44, -14, 1, 15, 13, 25,
+    58, 59, 46, 18, -19, -22, -20, -34, -45, -56, -50, -10, 22, 30, 37, 30,
+    37, 56, 38, 11, -21, -48, -40, -31, -38, -40, -34, -14, 30, 52, 45, 41,
+    27, 28, 33, 3, -29, -51, -61, -39, -21, -23, -16, 0, 24, 60, 62, 38,
+    25, 6, 3, 1, -32, -55, -60, -49, -17, 5, 3, 12, 31, 47, 66, 48,
+    11, -5, -21, -21, -24, -51, -59, -43, -17, 18, 33, 25, 32, 44, 47, 48,
+    13, -26, -35, -41, -34, -32, -47, -39, -8, 22, 48, 51, 31, 32, 36, 26,
+    13, -27, -56, -50, -42, -26, -19, -24, -5, 30, 52, 60, 46, 17, 14, 12,
+    -6, -22, -56, -66, -41, -21, -3, 6, 6, 26, 56, 59, 48, 21, -12, -12,
+    -15, -32, -43, -61, -50, -12, 12, 25, 29, 27, 42, 58, 41, 15, -16, -41,
+    -32, -30, -41, -42, -42, -15, 26, 42, 43, 38, 29, 35, 38, 6, -23, -47,
+    -57, -34, -26, -30, -20, -8, 23, 56, 56, 40, 27, 13, 13, 6, -30, -52,
+    -59, -50, -17, -5, -5, 9, 25, 49, 65, 46, 16, 1, -13, -14, -22, -53,
+    -58, -46, -22, 14, 22, 19, 31, 42, 53, 50, 15, -18, -28, -35, -30, -34,
+    -53, -40, -13, 16, 44, 41, 30, 36, 39, 33, 16, -24, -49, -45, -41, -28,
+    -26, -32, -7, 25, 47, 59, 41, 22, 22, 17, 1, -20, -54, -62, -40, -26,
+    -8, -3, -2, 27, 52, 58, 50, 20, -3, -3, -11, -28, -44, -62, -50, -14,
+    3, 19, 22, 22, 46, 57, 44, 20, -13, -32, -25, -29, -42, -45, -47, -18,
+    22, 33, 39, 34, 30, 44, 39, 11, -18, -43, -50, -32, -30, -35, -26, -14,
+    21, 52, 49, 41, 28, 19, 23, 8, -26, -48, -57, -47, -19, -13, -12, 4,
+    20, 50, 64, 43, 23, 5, -5, -5, -22, -51, -57, -47, -24, 9, 12, 13,
+    30, 41, 57, 51, 15, -9, -23, -28, -26, -38, -55, -42, -17, 11, 38, 33,
+    29, 39, 40, 41, 19, -21, -40, -41, -38, -29, -33, -37, -10, 20, 42, 55,
+    36, 26, 29, 21, 9, -18, -51, -55, -40, -28, -14, -12, -7, 25, 49, 56,
+    50, 20, 5, 5, -7, -22, -45, -62, -47, -19, -2, 11, 14, 20, 48, 56,
+    45, 25, -10, -21, -19, -29, -40, -50, -49, -19, 15, 26, 33, 31, 32, 49,
+    41, 15, -12, -40, -41, -30, -34, -37, -33, -18, 18, 46, 44, 40, 29, 24,
+    31, 10, -21, -43, -56, -42, -23, -21, -17, -3, 17, 48, 60, 41, 26, 10,
+    2, 3, -22, -48, -55, -50, -23, 1, 3, 9, 26, 40, 58, 51, 17, -2,
+    -16, -22, -21, -42, -55, -44, -22, 9, 29, 25, 27, 40, 43, 45, 21, -17,
+    -31, -37, -35, -29, -41, -39, -14, 14, 39, 48, 33, 29, 34, 26, 15, -15,
+    -48, -48, -41, -29, -18, -21, -10, 21, 44, 55, 48, 22, 13, 13, -2, -17,
+    -44, -61, -44, -24, -7, 5, 5, 19, 46, 55, 47, 26, -5, -12, -12, -27,
+    -38, -53, -51, -19, 7, 20, 27, 26, 35, 52, 43, 19, -7, -34, -33, -28,
+    -37, -39, -39, -22, 16, 37, 40, 37, 29, 31, 36, 13, -16, -38, -53, -38,
+    -25, -28, -21, -10, 14, 47, 54, 41, 28, 15, 11, 8, -20, -45, -53, -50,
+    -23, -6, -6, 5, 20, 40, 59, 48, 21, 4, -10, -14, -18, -43, -55, -45,
+    -27, 6, 20, 18, 27, 38, 47, 48, 22, -11, -24, -32, -31, -30, -46, -42,
+    -17, 8, 36, 40, 30, 33, 36, 32, 20, -13, -42, -43, -39, -30, -23, -29,
+    -13, 17, 39, 53, 43, 24, 20, 17, 4, -14, -43, -58, -42, -27, -12, -2,
+    -3, 18, 44, 53, 49, 26, 1, -3, -8, -23, -37, -54, -51, -20, 0, 14,
+    21, 20, 38, 52, 44, 24, -5, -27, -26, -26, -37, -42, -43, -24, 13, 29,
+    35, 34, 28, 38, 39, 17, -10, -35, -46, -34, -28, -33, -26, -16, 11, 44,
+    47, 40, 30, 19, 20, 12, -17, -41, -52, -48, -24, -13, -13, 1, 15, 39,
+    58, 45, 25, 9, -4, -5, -16, -42, -53, -47, -28, 1, 12, 11, 25, 36,
+    49, 51, 22, -4, -18, -26, -25, -32, -48, -43, -21, 4, 31, 33, 27, 35,
+    38, 38, 24, -11, -34, -38, -37, -29, -29, -35, -16, 13, 34, 50, 39, 25,
+    27, 21, 11, -10, -42, -52, -41, -29, -16, -10, -8, 16, 42, 51, 49, 26,
+    7, 6, -4, -18, -36, -55, -49, -24, -6, 8, 14, 17, 38, 53, 45, 28,
+    -2, -19, -18, -25, -36, -44, -47, -25, 7, 23, 30, 30, 29, 42, 42, 19,
+    -5, -32, -40, -30, -31, -35, -32, -21, 9, 38, 42, 38, 31, 23, 28, 15,
+    -14, -35, -50, -44, -25, -20, -17, -6, 11, 38, 55, 43, 28, 14, 3, 3,
+    -15, -41, -51, -48, -28, -4, 3, 7, 21, 35, 51, 51, 23, 2, -12, -20,
+    -20, -34, -50, -44, -26, 1, 24, 25, 25, 35, 40, 42, 27, -8, -27, -33,
+    -34, -28, -35, -38, -19, 7, 31, 44, 35, 27, 31, 26, 16, -7, -39, -46,
+    -39, -31, -19, -19, -13, 13, 37, 49, 47, 26, 13, 12, 1, -13, -35, -55,
+    -46, -26, -11, 2, 5, 14, 38, 51, 46, 30, 2, -11, -11, -22, -34, -46,
+    -50, -25, 1, 16, 25, 25, 30, 45, 43, 23, -1, -27, -33, -26, -33, -37,
+    -36, -25, 7, 31, 37, 36, 29, 28, 33, 18, -10, -31, -47, -40, -25, -26,
+    -22, -11, 7, 37, 50, 41, 29, 17, 10, 9, -12, -38, -48, -48, -29, -8,
+    -5, 2, 16, 33, 52, 49, 26, 7, -6, -13, -16, -34, -50, -44, -30, -2,
+    17, 17, 23, 33, 42, 46, 28, -4, -21, -28, -30, -28, -39, -41, -21, 2,
+    28, 38, 30, 30, 34, 31, 22, -5, -34, -41, -37, -31, -23, -26, -17, 10,
+    32, 47, 44, 26, 19, 17, 7, -9, -33, -52, -43, -28, -15, -3, -2, 12,
+    37, 48, 47, 30, 6, -3, -6, -18, -32, -47, -50, -26, -4, 10, 19, 19,
+    31, 47, 43, 27, 2, -21, -25, -24, -33, -38, -40, -28, 4, 25, 31, 33,
+    28, 33, 37, 21, -4, -28, -42, -36, -27, -30, -26, -17, 3, 35, 45, 39,
+    31, 20, 18, 14, -10, -34, -46, -46, -28, -13, -12, -3, 12, 31, 52, 46,
+    27, 12, -1, -5, -12, -34, -48, -45, -31, -5, 10, 10, 20, 32, 43, 48,
+    28, 1, -14, -23, -24, -28, -42, -43, -25, -2, 23, 32, 26, 31, 35, 35,
+    26, -3, -28, -35, -35, -30, -27, -31, -20, 6, 28, 44, 40, 26, 25, 22,
+    12, -4, -32, -48, -41, -30, -18, -10, -9, 9, 34, 46, 47, 31, 10, 5,
+    -1, -14, -30, -48, -48, -28, -9, 4, 12, 15, 31, 47, 44, 30, 6, -15,
+    -17, -21, -31, -39, -44, -29, 0, 18, 26, 29, 27, 36, 41, 23, 1, -24,
+    -37, -30, -29, -32, -30, -22, 1, 30, 39, 36, 31, 23, 25, 18, -7, -29,
+    -44, -44, -27, -19, -17, -8, 7, 29, 49, 44, 29, 17, 4, 2, -9, -33,
+    -46, -46, -32, -8, 2, 5, 16, 30, 44, 49, 28, 6, -8, -18, -19, -28,
+    -44, -43, -28, -6, 18, 24, 23, 31, 37, 38, 29, 0, -22, -30, -32, -28,
+    -31, -36, -22, 1, 24, 40, 36, 27, 29, 26, 17, 0, -30, -43, -38, -31,
+    -20, -17, -14, 7, 30, 44, 45, 30, 14, 12, 4, -10, -27, -48, -46, -28,
+    -14, 0, 5, 11, 30, 46, 44, 32, 8, -9, -10, -18, -30, -40, -47, -30,
+    -4, 12, 22, 24, 26, 39, 42, 26, 5, -19, -31, -26, -29, -34, -34, -27,
+    -1, 25, 34, 34, 29, 26, 30, 21, -3, -25, -41, -40, -27, -24, -22, -13,
+    2, 28, 45, 41, 30, 19, 11, 9, -6, -31, -43, -46, -32, -11, -5, 0,
+    13, 27, 45, 48, 29, 11, -3, -11, -14, -27, -44, -43, -31, -9, 13, 17,
+    20, 30, 37, 42, 31, 3, -16, -25, -28, -26, -34, -39, -24, -3, 20, 35,
+    30, 28, 31, 30, 22, 2, -26, -38, -36, -31, -23, -23, -19, 4, 26, 41,
+    43, 28, 19, 17, 9, -5, -26, -46, -44, -29, -18, -5, -2, 7, 30, 43,
+    45, 33, 11, -1, -5, -15, -27, -41, -47, -30, -8, 6, 16, 18, 26, 41,
+    42, 29, 8, -15, -23, -22, -29, -35, -37, -30, -3, 20, 28, 31, 28, 29,
+    35, 24, 1, -21, -37, -36, -27, -27, -26, -17, -2, 26, 41, 38, 31, 21,
+    17, 14, -4, -27, -41, -44, -31, -15, -12, -5, 8, 24, 44, 46, 30, 15,
+    2, -4, -9, -27, -43, -43, -33, -11, 7, 10, 17, 28, 37, 45, 31, 6,
+    -10, -20, -23, -25, -36, -41, -27, -7, 16, 29, 26, 28, 33, 32, 27, 4,
+    -22, -32, -33, -29, -25, -28, -22, 0, 22, 38, 40, 27, 23, 22, 13, 0,
+    -24, -43, -40, -31, -20, -11, -8, 4, 27, 41, 44, 33, 13, 6, 1, -11,
+    -24, -41, -46, -31, -12, 1, 10, 13, 25, 42, 42, 31, 11, -11, -16, -19,
+    -28, -35, -40, -32, -6, 14, 23, 27, 26, 31, 38, 26, 5, -17, -33, -30,
+    -27, -30, -29, -23, -5, 22, 36, 35, 31, 23, 22, 19, -1, -23, -38, -42,
+    -29, -19, -17, -9, 3, 22, 42, 43, 30, 18, 7, 2, -5, -26, -41, -43,
+    -34, -13, 0, 4, 13, 25, 38, 45, 32, 10, -4, -15, -18, -24, -38, -41,
+    -30, -11, 12, 22, 22, 27, 34, 36, 30, 7, -17, -26, -30, -27, -28, -33,
+    -24, -4, 18, 34, 35, 27, 26, 25, 18, 4, -22, -39, -37, -31, -22, -16,
+    -14, 1, 24, 38, 43, 32, 16, 11, 6, -7, -21, -41, -45, -30, -16, -3,
+    4, 8, 24, 40, 42, 33, 13, -5, -9, -15, -26, -35, -43, -33, -9, 8,
+    18, 22, 24, 34, 40, 28, 9, -13, -27, -25, -26, -31, -31, -27, -7, 19,
+    30, 32, 29, 25, 27, 23, 2, -19, -35, -39, -28, -23, -21, -14, -2, 20,
+    40, 40, 31, 21, 11, 8, -2, -24, -38, -42, -34, -15, -6, -2, 9, 22,
+    38, 45, 32, 14, 0, -9, -13, -22, -39, -41, -32, -14, 8, 15, 18, 26,
+    33, 39, 32, 9, -12, -21, -26, -25, -30, -36, -27, -7, 13, 30, 30, 26,
+    29, 28, 23, 7, -19, -34, -34, -30, -23, -21, -19, -1, 20, 35, 41, 30,
+    19, 17, 10, -2, -19, -39, -42, -31, -19, -8, -2, 4, 23, 38, 42, 34,
+    15, 1, -3, -11, -23, -35, -43, -33, -12, 3, 13, 17, 22, 35, 40, 30,
+    13, -9, -21, -21, -25, -32, -34, -30, -10, 14, 25, 29, 27, 26, 32, 25,
+    6, -15, -31, -35, -27, -25, -25, -18, -6, 18, 36, 36, 31, 22, 16, 14,
+    1, -20, -35, -41, -33, -17, -11, -6, 5, 19, 37, 44, 31, 17, 5, -3,
+    -8, -21, -37, -41, -33, -16, 3, 9, 14, 24, 33, 40, 33, 11, -6, -17,
+    -22, -23, -31, -38, -29, -11, 10, 25, 25, 25, 30, 31, 27, 10, -15, -28,
+    -31, -29, -25, -26, -23, -5, 16, 32, 38, 29, 22, 21, 14, 3, -17, -37,
+    -39, -31, -21, -12, -8, 0, 20, 36, 41, 34, 17, 6, 2, -8, -20, -35,
+    -43, -33, -15, -2, 8, 12, 20, 36, 40, 32, 16, -6, -15, -17, -24, -32,
+    -37, -32, -12, 9, 20, 25, 25, 28, 35, 27, 9, -10, -28, -30, -26, -27,
+    -27, -23, -9, 15, 32, 33, 30, 23, 20, 19, 4, -17, -32, -39, -31, -20,
+};
+
+/// @brief The sample bank, indexed by `SampleId`.
+const Sample SAMPLES[] = {
+    {WAVE_SINE, 256, 0, 62.5f},       // SAMPLE_SINE: looped wavetable
+    {WAVE_ORGAN, 256, 0, 62.5f},      // SAMPLE_ORGAN: looped wavetable
+    {PCM_CHIME, 4096, 4096, 1046.5f}, // SAMPLE_CHIME: one-shot PCM
+};
@@ -0,0 +1,21 @@
+/// @file sample_bank.h
+/// Sample bank of the alarm synthesizer.
+///
+/// The tables are generated by `tools/gen_samples.py` into sample_bank.cpp. The melody that
+/// plays them is in the configuration bundle (`config_bundle.h`).
+#ifndef SAMPLE_BANK_H
+#define SAMPLE_BANK_H
+
+#include "audio_synth.h"
+
+/// @brief Identifiers of the samples. Index into `SAMPLES`.
+enum SampleId
+{
+    SAMPLE_SINE = 0,  ///< Sine wavetable
+    SAMPLE_ORGAN = 1, ///< Organ wavetable (sine with a few harmonics)
+    SAMPLE_CHIME = 2, ///< Bell chime, one-shot
+};
+
+extern const Sample SAMPLES[];
+
+#endif
@@ -0,0 +1,53 @@
+/// @file settings_store.cpp
+/// Implementation of the SettingsStore class.
+///
+/// This file contains the storage of the clock settings in NVS. See settings_store.h.
+#include <Arduino.h>
+#include "settings_store.h"
+
+/// @brief A stored blob: the settings, tagged with their version.
+struct StoredSettings
+{
+    uint8_t version;        ///< `SETTINGS_VERSION`
+    ClockSettings settings; ///< The settings
+};
+
+/// @brief Open the NVS namespace and restore the stored settings into the clock.
+///
+/// Called from `setup()`, before the first frame, so the clock starts with its settings.
+/// @param clock The clock.
+/// @return `true` if settings were restored, `false` if none were stored (or in an older format).
+bool SettingsStore::restore(Clock *clock)
+{
+    this->clock = clock;
+    preferences.begin("clock", false);
+
+    StoredSettings stored;
+    if (preferences.getBytesLength("settings") != sizeof(stored) ||
+        preferences.getBytes("settings", &stored, sizeof(stored)) != sizeof(stored) || stored.version != SETTINGS_VERSION)
+    {
+        return false;
+    }
+    clock->restore(stored.settings);
+    return true;
+}
+
+/// @brief Save the settings once they stopped changing for `SETTINGS_SAVE_DELAY_MS`. Called from `loop()`.
+///
+/// Writing NVS disables the flash cache for a few milliseconds. The Arduino core doesn't register the timer
+/// and button ISRs as IRAM-safe (`ESP_INTR_FLAG_IRAM`, only with `CONFIG_ARDUINO_ISR_IRAM`), so they are
+/// held off until the write ends: a tick or a press is late by that much, not lost.
+void SettingsStore::poll()
+{
+    if (clock->take_settings_changed())
+    {
+        pending = true;
+        changed_ms = millis();
+    }
+    if (pending && millis() - changed_ms >= SETTINGS_SAVE_DELAY_MS)
+    {
+        StoredSettings stored = {SETTINGS_VERSION, clock->settings()};
+        preferences.putBytes("settings", &stored, sizeof(stored));
+        pending = false;
+    }
+}
@@ -0,0 +1,30 @@
+/// @file settings_store.h
+/// Interfaces the SettingsStore class.
+///
+/// Keeps the clock settings (`ClockSettings`: alarm, recurrence, time zone, snooze and countdown
+/// durations) in the NVS partition, so they survive resets and power losses. They are stored as
+/// a single blob, read back in one access at startup, before the display starts.
+#ifndef SETTINGS_STORE_H
+#define SETTINGS_STORE_H
+
+#include <Arduino.h>
+#include <Preferences.h>
+#include "clock.h"
+
+#define SETTINGS_VERSION 1          ///< Version of the stored blob. Increment when `ClockSettings` changes.
+#define SETTINGS_SAVE_DELAY_MS 2000 ///< Quiet time after a change before saving, so a burst of presses is written once
+
+class SettingsStore
+{
+private:
+    Clock *clock = nullptr;       ///< The clock whose settings are kept
+    Preferences preferences;      ///< The `clock` NVS namespace
+    bool pending = false;         ///< A change is waiting to be saved
+    uint32_t changed_ms = 0;      ///< Time of the last change
+
+public:
+    bool restore(Clock *clock);
+    void poll();
+};
+
+#endif
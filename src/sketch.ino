@@ -1,4 +1,12 @@
 #include "clock.h"
+#include "time_sync.h"
+#include "settings_store.h"
+#include "boot_profile.h"
+#include "hal/gpio_ll.h"
+#if CLOCK_LOW_POWER
+#include "driver/gpio.h"
+#include "esp_sleep.h"
+#endif
 
 // Hardware pins for buttons, alarm switch and buzzer pin
 // For devkit v4
@@ -8,81 +16,178 @@
 #define OK_PIN 0
 
 #define ALARM_PIN 15
+#if ALARM_AUDIO_PCM
+#define BUZZER_PIN 25 // Speaker on the DAC output
+#else
 #define BUZZER_PIN 12
+#endif
 
 TM1637 display(5, 18);
 Clock clk;
+TimeSync time_sync;
+SettingsStore settings;
+BootProfile boot;
+
+#if !CLOCK_KEY_SCAN
+/// @brief Whether a button interrupt is a press.
+///
+/// In the low-power mode, the buttons wake the CPU from light sleep, which only level interrupts can do.
+/// A low-level interrupt would keep firing, and waking the CPU, for as long as the button is held, so each
+/// interrupt re-arms the pin for the opposite level: the press and the release fire once each.
+/// Otherwise the interrupts are on the falling edge, and always a press.
+/// @param pin The button pin.
+static bool IRAM_ATTR buttonPressed(uint8_t pin)
+{
+#if CLOCK_LOW_POWER
+    bool down = gpio_ll_get_level(&GPIO, (gpio_num_t)pin) == 0; // Buttons are active low
+    gpio_ll_set_intr_type(&GPIO, (gpio_num_t)pin, down ? GPIO_INTR_HIGH_LEVEL : GPIO_INTR_LOW_LEVEL);
+    return down;
+#else
+    return true;
+#endif
+}
 
 // Interrupt Service Routines for buttons
 void IRAM_ATTR buttonMenuInterrupt()
 {
-    clk.handleButtonMenuPress();
+    if (buttonPressed(MENU_PIN))
+    {
+        clk.press(BUTTON_MENU);
+    }
 }
 
 void IRAM_ATTR buttonOkInterrupt()
 {
-    clk.handleButtonOkPress();
+    if (buttonPressed(OK_PIN))
+    {
+        clk.press(BUTTON_OK);
+    }
 }
 
 void IRAM_ATTR buttonPlusInterrupt()
 {
-    clk.handleButtonPlusPress();
+    if (buttonPressed(PLUS_PIN))
+    {
+        clk.press(BUTTON_PLUS);
+    }
 }
 
 void IRAM_ATTR buttonMinusInterrupt()
 {
-    clk.handleButtonMinusPress();
+    if (buttonPressed(MINUS_PIN))
+    {
+        clk.press(BUTTON_MINUS);
+    }
 }
+#endif
 
-// Interrupt Service Routine for the Alarm Switch
+// Interrupt Service Routine for the Alarm Switch. Reads the pin register: `digitalRead()` is in flash.
 void IRAM_ATTR switchAlarmInterrupt()
 {
-    clk.handleSwitchAlarmChange(digitalRead(ALARM_PIN));
+    clk.handleSwitchAlarmChange(gpio_ll_get_level(&GPIO, (gpio_num_t)ALARM_PIN));
 }
 
 void setup()
 {
+    boot.mark("startup"); // From the start of the application to `setup()`
 
     // Initiate the serial console
     Serial.begin(115200);
-    // Configure buttons as inputs with pull-up
-    pinMode(MENU_PIN, INPUT_PULLUP);
-    pinMode(PLUS_PIN, INPUT_PULLUP);
-    pinMode(MINUS_PIN, INPUT_PULLUP);
-    pinMode(OK_PIN, INPUT_PULLUP);
-
-    pinMode(ALARM_PIN, INPUT_PULLUP); // Alarm switch
-
-    // Attach interrupt for the buttons
-    attachInterrupt(digitalPinToInterrupt(MENU_PIN), buttonMenuInterrupt, FALLING); // Call the four buttons ISRs
-    attachInterrupt(digitalPinToInterrupt(OK_PIN), buttonOkInterrupt, FALLING);
-    attachInterrupt(digitalPinToInterrupt(PLUS_PIN), buttonPlusInterrupt, FALLING);
-    attachInterrupt(digitalPinToInterrupt(MINUS_PIN), buttonMinusInterrupt, FALLING);
+    boot.mark("serial");
 
-    attachInterrupt(digitalPinToInterrupt(ALARM_PIN), switchAlarmInterrupt, CHANGE); // Call the alarm switch ISR
-
-    display.init();
-    display.set(BRIGHT_TYPICAL);
+    // Use the configuration bundle of the flash partition, if there is a valid one (see tools/mkbundle.py)
+    bool bundle_loaded = config_bundle.load();
+    boot.mark("config");
 
     // Clock class init
     clk.init(&display, BUZZER_PIN);
+    boot.mark("clock init");
+
+    // Restore the state before the display starts, so the first frame is already right
+    bool restored = settings.restore(&clk); // Alarm, recurrence, time zone, snooze and countdown durations
+    pinMode(ALARM_PIN, INPUT_PULLUP);       // Alarm switch
     clk.handleSwitchAlarmChange(digitalRead(ALARM_PIN)); // Read the alarm switch pin and update the clock
+#if CLOCK_LOW_POWER
+    clk.set_colon_blink(false); // Keep the colon steady, so the CPU only wakes up on minute rollovers
+#endif
+    /* Uncomment the following lines to set the time zone and date,
+       and to ring the alarm on weekdays only (they override the
+       restored settings)
+    */
+    // clk.set_time_zone(TZ_CENTRAL_EU);
+    // clk.set_date(2024, 12, 2);
+    // clk.set_alarm_days(WEEKDAYS);
     /* Uncomment the following lines to set the time
        and alarm for testing, it will set it to 23:02:55
        with alarm at 23:03. Remember to enable the alarm
        using the slide switch
     */
     clk.set_time(18, 56, 55);
-    clk.set_alarm(18, 57);
+    if (!restored)
+    {
+        clk.set_alarm(18, 57);
+    }
     // clk.set_time(23, 02, 55);
     // clk.set_alarm(23, 03);
+    boot.mark("restore");
+
+    // Clear the display and show the first frame in a single transfer
+    display.set(BRIGHT_TYPICAL);
+    clk.show_first_frame();
+    boot.mark_first_frame();
 
     // Start the clock
     clk.run();
+    boot.mark("clock run");
+
+#if !CLOCK_KEY_SCAN // With key-scan, the buttons are read through the TM1637
+    // Configure buttons as inputs with pull-up
+    pinMode(MENU_PIN, INPUT_PULLUP);
+    pinMode(PLUS_PIN, INPUT_PULLUP);
+    pinMode(MINUS_PIN, INPUT_PULLUP);
+    pinMode(OK_PIN, INPUT_PULLUP);
+
+    // Attach interrupt for the buttons
+    attachInterrupt(digitalPinToInterrupt(MENU_PIN), buttonMenuInterrupt, FALLING); // Call the four buttons ISRs
+    attachInterrupt(digitalPinToInterrupt(OK_PIN), buttonOkInterrupt, FALLING);
+    attachInterrupt(digitalPinToInterrupt(PLUS_PIN), buttonPlusInterrupt, FALLING);
+    attachInterrupt(digitalPinToInterrupt(MINUS_PIN), buttonMinusInterrupt, FALLING);
+#endif
+
+    attachInterrupt(digitalPinToInterrupt(ALARM_PIN), switchAlarmInterrupt, CHANGE); // Call the alarm switch ISR
+
+#if CLOCK_LOW_POWER
+    // Wake the CPU from light sleep when any button is pressed (buttons are active low). This turns the button
+    // interrupts into low-level ones, which `buttonPressed()` flips between the press and the release.
+    gpio_wakeup_enable((gpio_num_t)MENU_PIN, GPIO_INTR_LOW_LEVEL);
+    gpio_wakeup_enable((gpio_num_t)OK_PIN, GPIO_INTR_LOW_LEVEL);
+    gpio_wakeup_enable((gpio_num_t)PLUS_PIN, GPIO_INTR_LOW_LEVEL);
+    gpio_wakeup_enable((gpio_num_t)MINUS_PIN, GPIO_INTR_LOW_LEVEL);
+    esp_sleep_enable_gpio_wakeup();
+#endif
+    boot.mark("interrupts"); // The interrupts are attached once the clock runs, so they never see it half initialized
+
+    // Listen for the serial time synchronization protocol
+    time_sync.init(&clk, &Serial);
+
+    if (!bundle_loaded)
+    {
+        Serial.println("[config] No valid bundle in the config partition, using the built-in one");
+    }
+    boot.report(Serial);
 }
 
 void loop()
 {
-    // Delay to help with simulation running
-    delay(100);
+#if CLOCK_LOW_POWER
+    clk.sleep_until_next_deadline();
+    clk.handleSwitchAlarmChange(digitalRead(ALARM_PIN)); // The switch interrupt doesn't wake the CPU, read it on every wake-up
+    time_sync.poll();                                    // The UART doesn't wake the CPU either, sync only works while awake
+    settings.poll();                                     // Save the changed settings
+#else
+    time_sync.poll();
+    settings.poll(); // Save the changed settings
+    // Short delay: the polling period adds to the measured round-trip delay of the time sync
+    delay(1);
+#endif
 }
@@ -0,0 +1,61 @@
+/// @file time_sync.cpp
+/// Implementation of the TimeSync class.
+///
+/// This file contains the implementation of the serial time synchronization protocol. See time_sync.h.
+#include <Arduino.h>
+#include "time_sync.h"
+#include "esp_timer.h"
+
+/// @brief Set the clock to synchronize and the serial console to listen on.
+/// @param clock The clock.
+/// @param serial The serial console, e.g. `&Serial`.
+void TimeSync::init(Clock *clock, Stream *serial)
+{
+    this->clock = clock;
+    this->serial = serial;
+}
+
+/// @brief Read the characters received on the serial console, and handle complete command lines.
+///
+/// The receive time t2 is read from the monotonic counter as soon as the end of the line is seen,
+/// so call this function often: the polling period adds to the measured round-trip delay.
+void TimeSync::poll()
+{
+    while (serial->available())
+    {
+        char c = serial->read();
+        if (c == '\n' || c == '\r')
+        {
+            int64_t received_us = esp_timer_get_time();
+            if (length)
+            {
+                line[length] = '\0';
+                handle(received_us);
+            }
+            length = 0;
+        }
+        else if (length < SYNC_LINE_LENGTH - 1)
+        {
+            line[length++] = c;
+        }
+    }
+}
+
+/// @brief Handle a complete command line.
+/// @param received_us Monotonic time the line was received at, in microseconds.
+void TimeSync::handle(int64_t received_us)
+{
+    if (strncmp(line, "SYNC ", 5) == 0)
+    {
+        long long t1 = strtoll(line + 5, nullptr, 10);
+        long long t2 = clock->utc_us(received_us);
+        long long t3 = clock->utc_us(esp_timer_get_time()); // As late as possible before sending
+        serial->printf("SYNC %lld %lld %lld\n", t1, t2, t3);
+    }
+    else if (strncmp(line, "ADJ ", 4) == 0)
+    {
+        long long offset = strtoll(line + 4, nullptr, 10); // 64 bits: the clock boots in 1970, decades off
+        clock->adjust(offset);
+        serial->printf("ADJ %lld\n", offset);
+    }
+}
@@ -0,0 +1,39 @@
+/// @file time_sync.h
+/// Interfaces the TimeSync class.
+///
+/// Serial time synchronization protocol. An NTP-style exchange over the serial console
+/// (115200 baud), answered with timestamps read from the monotonic counter:
+///
+/// Host to clock             | Clock to host                  | Meaning
+/// --------------------------|--------------------------------|---------------------------------------------
+/// `SYNC <t1>`               | `SYNC <t1> <t2> <t3>`          | t1: host send time, t2: clock receive time, t3: clock send time
+/// `ADJ <offset>`            | `ADJ <offset>`                 | Correct the clock by `offset` (host minus clock)
+///
+/// All times are microseconds since 1970-01-01 UTC. With the host receive time t4, the host computes
+/// the clock offset @f$\theta = \frac{(t_2 - t_1) + (t_3 - t_4)}{2}@f$ and the round-trip delay
+/// @f$\delta = (t_4 - t_1) - (t_3 - t_2)@f$, and sends `ADJ` with @f$-\theta@f$.
+/// See `tools/timesync.py` for the host side.
+#ifndef TIME_SYNC_H
+#define TIME_SYNC_H
+
+#include <Arduino.h>
+#include "clock.h"
+
+#define SYNC_LINE_LENGTH 48 ///< Longest command line, including the terminating null
+
+class TimeSync
+{
+private:
+    Clock *clock = nullptr;        ///< The clock to read and correct
+    Stream *serial = nullptr;      ///< The serial console
+    char line[SYNC_LINE_LENGTH];   ///< Command line being received
+    uint8_t length = 0;            ///< Characters in `line`
+
+    void handle(int64_t received_us);
+
+public:
+    void init(Clock *clock, Stream *serial);
+    void poll();
+};
+
+#endif
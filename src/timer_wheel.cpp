@@ -0,0 +1,125 @@
+/// @file timer_wheel.cpp
+/// Implementation of the TimerWheel class.
+///
+/// This file contains the implementation of the hierarchical timer wheel.
+#include "esp_attr.h"
+#include "timer_wheel.h"
+
+/// @brief Schedule a timer to expire after a number of ticks. Reschedules it if it is already pending.
+/// @param timer The timer. Must stay alive while it is scheduled.
+/// @param ticks Ticks from now. 0 is treated as 1, longer delays than `MAX_TICKS` are cut to `MAX_TICKS`.
+/// @param callback Called from `tick()` when the timer expires.
+/// @param context Argument of the callback.
+void IRAM_ATTR TimerWheel::schedule(WheelTimer &timer, uint32_t ticks, void (*callback)(void *), void *context)
+{
+    cancel(timer);
+    ticks = ticks < 1 ? 1 : ticks > MAX_TICKS ? MAX_TICKS : ticks;
+    timer.expires = now + ticks;
+    timer.callback = callback;
+    timer.context = context;
+    insert(timer);
+}
+
+/// @brief Cancel a timer. Does nothing if the timer isn't scheduled.
+/// @param timer The timer.
+void IRAM_ATTR TimerWheel::cancel(WheelTimer &timer)
+{
+    if (!timer.pprev)
+    {
+        return;
+    }
+    *timer.pprev = timer.next; // Unlink from the slot list
+    if (timer.next)
+    {
+        timer.next->pprev = timer.pprev;
+    }
+    timer.next = nullptr;
+    timer.pprev = nullptr;
+}
+
+/// @brief Advance the wheel by one tick and run the callbacks of the timers that expire.
+///
+/// When a level wraps around, the next slot of the level above is cascaded down first.
+void IRAM_ATTR TimerWheel::tick()
+{
+    now++;
+    uint8_t wrapped = 0; // Number of levels that wrapped around on this tick
+    while (wrapped < LEVELS - 1 && (now >> (SLOT_BITS * wrapped) & (SLOTS - 1)) == 0)
+    {
+        wrapped++;
+    }
+    for (uint8_t level = wrapped; level > 0; level--) // Coarsest level first, so its timers can cascade further down
+    {
+        cascade(level);
+    }
+
+    WheelTimer **slot = &slots[0][now & (SLOTS - 1)];
+    while (*slot) // Callbacks may schedule or cancel timers, so unlink one timer at a time
+    {
+        WheelTimer &timer = **slot;
+        cancel(timer);
+        timer.callback(timer.context);
+    }
+}
+
+/// @brief Ticks until the next tick that expires or cascades a timer.
+///
+/// Scans at most one revolution of each level, so the cost is bounded by the wheel size.
+/// Upper levels cascade their current slot once more, a whole revolution later: timers
+/// scheduled up to `SLOTS` groups ahead land in it.
+/// Used by the low-power mode to sleep until the next timer.
+/// @return Ticks from now, or `UINT32_MAX` if no timer is scheduled.
+uint32_t TimerWheel::ticks_to_next() const
+{
+    uint32_t next = UINT32_MAX;
+    for (uint8_t level = 0; level < LEVELS; level++)
+    {
+        uint8_t shift = SLOT_BITS * level;
+        uint32_t last = level ? SLOTS : SLOTS - 1; // Upper levels: the current slot holds the timers of the next revolution
+        for (uint32_t i = 1; i <= last; i++)
+        {
+            uint32_t group = (now >> shift) + i; // Level 0: a tick. Upper levels: the tick the slot cascades at.
+            if (slots[level][group & (SLOTS - 1)])
+            {
+                uint32_t ticks = (group << shift) - now;
+                next = ticks < next ? ticks : next;
+                break;
+            }
+        }
+    }
+    return next;
+}
+
+/// @brief Link a timer into the slot of the finest level that covers its delay.
+/// @param timer The timer, with `expires` set.
+void IRAM_ATTR TimerWheel::insert(WheelTimer &timer)
+{
+    uint32_t delta = timer.expires - now;
+    uint8_t level = 0;
+    while (level < LEVELS - 1 && delta >> (SLOT_BITS * (level + 1)))
+    {
+        level++;
+    }
+
+    WheelTimer **head = &slots[level][(timer.expires >> (SLOT_BITS * level)) & (SLOTS - 1)];
+    timer.next = *head;
+    if (timer.next)
+    {
+        timer.next->pprev = &timer.next;
+    }
+    timer.pprev = head;
+    *head = &timer;
+}
+
+/// @brief Move the timers of the current slot of a level down to the finer levels.
+/// @param level The level, 1 or above.
+void IRAM_ATTR TimerWheel::cascade(uint8_t level)
+{
+    WheelTimer **slot = &slots[level][(now >> (SLOT_BITS * level)) & (SLOTS - 1)];
+    while (*slot)
+    {
+        WheelTimer &timer = **slot;
+        cancel(timer);
+        insert(timer);
+    }
+}
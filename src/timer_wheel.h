@@ -0,0 +1,51 @@
+/// @file timer_wheel.h
+/// Interfaces the TimerWheel class.
+///
+/// A hierarchical timer wheel, driven by the clock tick. Insert, cancel and expire are O(1):
+/// a tick only looks at the one slot that is due, and timers far in the future wait in
+/// coarser levels until they are cascaded down.
+#ifndef TIMER_WHEEL_H
+#define TIMER_WHEEL_H
+
+#include <cstdint>
+#include "esp_attr.h"
+
+/// @brief A timer that can be scheduled on a `TimerWheel`.
+///
+/// The timer is owned by the caller; the wheel only links it into its slots, so scheduling never allocates.
+struct WheelTimer
+{
+    WheelTimer *next = nullptr;         ///< Next timer in the same slot
+    WheelTimer **pprev = nullptr;       ///< The pointer pointing to this timer. `nullptr` when the timer isn't scheduled.
+    uint32_t expires = 0;               ///< Tick the timer expires at
+    void (*callback)(void *) = nullptr; ///< Called when the timer expires
+    void *context = nullptr;            ///< Argument of the callback
+};
+
+/// @brief Hierarchical timer wheel.
+///
+/// Three levels of 64 slots. With a 0.5 second tick, level 0 covers 32 seconds with a
+/// resolution of one tick, level 1 covers 34 minutes and level 2 covers 36 hours.
+class TimerWheel
+{
+public:
+    static const uint8_t LEVELS = 3;
+    static const uint8_t SLOT_BITS = 6;
+    static const uint32_t SLOTS = 1 << SLOT_BITS;
+    static const uint32_t MAX_TICKS = (1UL << (SLOT_BITS * LEVELS)) - 1; ///< Longest delay that can be scheduled
+
+    void schedule(WheelTimer &timer, uint32_t ticks, void (*callback)(void *), void *context);
+    void cancel(WheelTimer &timer);
+    IRAM_ATTR bool pending(const WheelTimer &timer) const { return timer.pprev != nullptr; }
+    void tick();
+    uint32_t ticks_to_next() const;
+
+private:
+    WheelTimer *slots[LEVELS][SLOTS] = {}; ///< Heads of the timer lists of each slot
+    uint32_t now = 0;                      ///< Ticks since the wheel started
+
+    void insert(WheelTimer &timer);
+    void cascade(uint8_t level);
+};
+
+#endif
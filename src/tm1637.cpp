@@ -1,7 +1,7 @@
 
 /*
     TM1637.cpp
-    A library for the 4 digit display
+    A library for the 4 or 6 digit display
 
     TM1637 chip datasheet:
     https://www.mcielectronics.cl/website_MCI/static/documents/Datasheet_TM1637.pdf
@@ -35,6 +35,8 @@
 
 #include "tm1637.h"
 #include <Arduino.h>
+#include "hal/gpio_ll.h"
+#include "esp_rom_sys.h"
 
 //  --0x01--
 // |        |
@@ -111,75 +113,174 @@ namespace {
     }
 }
 
+// Segments of the ASCII characters, filled from char2segments() by the constructor.
+// coding() runs in the timer ISR: unlike the switch, which may compile to a jump table
+// in flash, this table is in RAM (see tools/iram_check.py).
+static uint8_t ascii_tab[128];
+
 static int8_t tube_tab[] = {0x3f, 0x06, 0x5b, 0x4f,
                             0x66, 0x6d, 0x7d, 0x07,
                             0x7f, 0x6f, 0x77, 0x7c,
                             0x39, 0x5e, 0x79, 0x71
                            }; //0~9,A,b,C,d,E,F
 
+// Bus primitives. The bus runs in the timer ISR, which is kept IRAM-safe (see tools/iram_check.py),
+// and the Arduino pin functions are in flash: the pins are driven through the GPIO registers, and
+// the delays are the ROM one.
+#define EDGE_DELAY_US 2 // The TM1637 clocks up to 250 kHz: hold each level, register writes alone are too fast
+
+static inline void IRAM_ATTR pinLevel(uint8_t pin, uint8_t level) {
+    gpio_ll_set_level(&GPIO, (gpio_num_t)pin, level);
+    esp_rom_delay_us(EDGE_DELAY_US);
+}
+
+static inline int IRAM_ATTR pinRead(uint8_t pin) {
+    return gpio_ll_get_level(&GPIO, (gpio_num_t)pin);
+}
+
+// The constructor sets the pins up as input and output (OUTPUT): releasing the data line
+// to the TM1637 only turns its output driver off.
+static inline void IRAM_ATTR pinDrive(uint8_t pin, bool drive) {
+    if (drive) {
+        gpio_ll_output_enable(&GPIO, (gpio_num_t)pin);
+    } else {
+        gpio_ll_output_disable(&GPIO, (gpio_num_t)pin);
+    }
+}
+
 TM1637::TM1637(uint8_t clk, uint8_t data) {
     clkpin = clk;
     datapin = data;
     pinMode(clkpin, OUTPUT);
     pinMode(datapin, OUTPUT);
+
+    for (uint8_t c = 0; c < sizeof(ascii_tab); c++) {
+        ascii_tab[c] = char2segments(c);
+    }
 }
 
 void TM1637::init(void) {
     clearDisplay();
 }
 
-int TM1637::writeByte(int8_t wr_data) {
+// Clear the display and show a first frame, in one auto-increment transfer: the frame, then blanks up to
+// the last display register, then the display control that turns the display on. Replaces init()
+// followed by a first displaySegments(), which take one fixed-address transaction per digit and a transfer.
+void TM1637::begin(const uint8_t seg_data[]) {
+    start();
+    writeByte(ADDR_AUTO);
+    stop();
+    start();
+    writeByte(cmd_set_addr);
+
+    for (uint8_t i = 0; i < GRIDS; i++) {
+        writeByte(i < DIGITS ? seg_data[i] : 0x00); // Registers of missing digits are cleared too
+    }
+
+    stop();
+    start();
+    writeByte(cmd_disp_ctrl);
+    stop();
+}
+
+int IRAM_ATTR TM1637::writeByte(int8_t wr_data) {
     for (uint8_t i = 0; i < 8; i++) { // Sent 8bit data
-        digitalWrite(clkpin, LOW);
+        pinLevel(clkpin, LOW);
 
         if (wr_data & 0x01) {
-            digitalWrite(datapin, HIGH);    // LSB first
+            pinLevel(datapin, HIGH);    // LSB first
         } else {
-            digitalWrite(datapin, LOW);
+            pinLevel(datapin, LOW);
         }
 
         wr_data >>= 1;
-        digitalWrite(clkpin, HIGH);
+        pinLevel(clkpin, HIGH);
     }
 
-    digitalWrite(clkpin, LOW); // Wait for the ACK
-    digitalWrite(datapin, HIGH);
-    digitalWrite(clkpin, HIGH);
-    pinMode(datapin, INPUT);
+    pinLevel(clkpin, LOW); // Wait for the ACK
+    pinLevel(datapin, HIGH);
+    pinLevel(clkpin, HIGH);
+    pinDrive(datapin, false);
 
     bitDelay();
-    uint8_t ack = digitalRead(datapin);
+    uint8_t ack = pinRead(datapin);
 
     if (ack == 0) {
-        pinMode(datapin, OUTPUT);
-        digitalWrite(datapin, LOW);
+        pinDrive(datapin, true);
+        pinLevel(datapin, LOW);
     }
 
     bitDelay();
-    pinMode(datapin, OUTPUT);
+    pinDrive(datapin, true);
     bitDelay();
 
     return ack;
 }
 
+// Read 8bit data from tm1637, LSB first. The TM1637 shifts each bit out on the falling clock edge.
+uint8_t IRAM_ATTR TM1637::readByte(void) {
+    uint8_t rd_data = 0;
+    pinDrive(datapin, false); // Release the data line to the TM1637
+
+    for (uint8_t i = 0; i < 8; i++) {
+        pinLevel(clkpin, LOW);
+        bitDelay();
+        pinLevel(clkpin, HIGH);
+
+        if (pinRead(datapin)) {
+            rd_data |= 1 << i;
+        }
+    }
+
+    pinLevel(clkpin, LOW); // Clock the ACK, driven by the TM1637
+    bitDelay();
+    pinLevel(clkpin, HIGH);
+    pinLevel(clkpin, LOW);
+    pinDrive(datapin, true);
+
+    return rd_data;
+}
+
+// Read the key-scan code (one transaction: command, then the code).
+// NO_KEY when no key is pressed, otherwise see decodeKey().
+uint8_t IRAM_ATTR TM1637::readKeys(void) {
+    start();
+    writeByte(READ_KEYS);
+    uint8_t code = readByte();
+    stop();
+    return code;
+}
+
+// Key number of a key-scan code: 0~7 for SG1~SG8 on K1 (codes 0xf7~0xf0),
+// 8~15 for SG1~SG8 on K2 (codes 0xef~0xe8). -1 for NO_KEY or an invalid code.
+int8_t IRAM_ATTR TM1637::decodeKey(uint8_t code) {
+    int8_t segment = 7 - (code & 0x07);
+
+    switch (code & 0xf8) {
+        case 0xf0 : return segment;     // K1
+        case 0xe8 : return 8 + segment; // K2
+    }
+    return -1;
+}
+
 // Send start signal to TM1637 (start = when both pins goes low)
-void TM1637::start(void) {
-    digitalWrite(clkpin, HIGH);
-    digitalWrite(datapin, HIGH);
-    digitalWrite(datapin, LOW);
-    digitalWrite(clkpin, LOW);
+void IRAM_ATTR TM1637::start(void) {
+    pinLevel(clkpin, HIGH);
+    pinLevel(datapin, HIGH);
+    pinLevel(datapin, LOW);
+    pinLevel(clkpin, LOW);
 }
 
 // End of transmission (stop = when both pins goes high)
-void TM1637::stop(void) {
-    digitalWrite(clkpin, LOW);
-    digitalWrite(datapin, LOW);
-    digitalWrite(clkpin, HIGH);
-    digitalWrite(datapin, HIGH);
+void IRAM_ATTR TM1637::stop(void) {
+    pinLevel(clkpin, LOW);
+    pinLevel(datapin, LOW);
+    pinLevel(clkpin, HIGH);
+    pinLevel(datapin, HIGH);
 }
 
 // Display function.Write to full-screen.
-void TM1637::display(int8_t disp_data[]) {
+void IRAM_ATTR TM1637::display(int8_t disp_data[]) {
     int8_t seg_data[DIGITS];
     uint8_t i;
 
@@ -188,13 +289,19 @@ void TM1637::display(int8_t disp_data[]) {
     }
 
     coding(seg_data);
+    displaySegments((uint8_t *)seg_data);
+}
+
+// Write already encoded segments to full-screen.
+// If keys isn't null, the key-scan code is read at the end of the same refresh.
+void IRAM_ATTR TM1637::displaySegments(const uint8_t seg_data[], uint8_t *keys) {
     start();              // Start signal sent to TM1637 from MCU
     writeByte(ADDR_AUTO); // Command1: Set data
     stop();
     start();
     writeByte(cmd_set_addr); // Command2: Set address (automatic address adding)
 
-    for (i = 0; i < DIGITS; i++) {
+    for (uint8_t i = 0; i < DIGITS; i++) {
         writeByte(seg_data[i]);    // Transfer display data (8 bits x num_of_digits)
     }
 
@@ -202,13 +309,17 @@ void TM1637::display(int8_t disp_data[]) {
     start();
     writeByte(cmd_disp_ctrl); // Control display
     stop();
+
+    if (keys) {
+        *keys = readKeys();
+    }
 }
 
 //******************************************
-void TM1637::display(uint8_t bit_addr, int8_t disp_data) {
+void IRAM_ATTR TM1637::display(uint8_t bit_addr, int8_t disp_data) {
     int8_t seg_data;
 
-    seg_data = coding(disp_data);
+    seg_data = coding(disp_data, bit_addr);
     start();               // Start signal sent to TM1637 from MCU
     writeByte(ADDR_FIXED); // Command1: Set data
     stop();
@@ -284,10 +395,9 @@ void TM1637::displayStr(char str[], uint16_t loop_delay) {
 }
 
 void TM1637::clearDisplay(void) {
-    display(0x00, 0x7f);
-    display(0x01, 0x7f);
-    display(0x02, 0x7f);
-    display(0x03, 0x7f);
+    for (uint8_t i = 0; i < DIGITS; i++) {
+        display(i, 0x7f);
+    }
 }
 
 // To take effect the next time it displays.
@@ -300,17 +410,17 @@ void TM1637::set(uint8_t brightness, uint8_t set_data, uint8_t set_addr) {
 
 // Whether to light the clock point ":".
 // To take effect the next time it displays.
-void TM1637::point(boolean PointFlag) {
+void IRAM_ATTR TM1637::point(boolean PointFlag) {
     _PointFlag = PointFlag;
 }
 
-void TM1637::coding(int8_t disp_data[]) {
+void IRAM_ATTR TM1637::coding(int8_t disp_data[]) {
     for (uint8_t i = 0; i < DIGITS; i++) {
-        disp_data[i] = coding(disp_data[i]);
+        disp_data[i] = coding(disp_data[i], i);
     }
 }
 
-int8_t TM1637::coding(int8_t disp_data) {
+int8_t IRAM_ATTR TM1637::coding(int8_t disp_data, uint8_t bit_addr) {
     if (disp_data == 0x7f) {
         disp_data = 0x00;    // Clear digit
     } else if (disp_data >= 0 && disp_data < int(sizeof(tube_tab) / sizeof(*tube_tab))) {
@@ -318,13 +428,13 @@ int8_t TM1637::coding(int8_t disp_data) {
     } else if (disp_data >= '0' && disp_data <= '9') {
         disp_data = tube_tab[int(disp_data) - 48];    // char to int (char "0" = ASCII 48)
     } else {
-        disp_data = char2segments(disp_data);
+        disp_data = disp_data >= 0 ? ascii_tab[int(disp_data)] : 0;
     }
-    disp_data += _PointFlag == POINT_ON ? 0x80 : 0;
+    disp_data += _PointFlag == POINT_ON && bit_addr == TM1637_POINT_DIGIT ? 0x80 : 0;
 
     return disp_data;
 }
 
-void TM1637::bitDelay(void) {
-    delayMicroseconds(50);
+void IRAM_ATTR TM1637::bitDelay(void) {
+    esp_rom_delay_us(50);
 }
@@ -1,6 +1,6 @@
 /*
     TM1637.h
-    A library for the 4 digit display
+    A library for the 4 or 6 digit display
 
     TM1637 chip datasheet:
     https://www.mcielectronics.cl/website_MCI/static/documents/Datasheet_TM1637.pdf
@@ -39,8 +39,11 @@
 /*******************Definitions for TM1637*********************/
 #define ADDR_AUTO 0x40
 #define ADDR_FIXED 0x44
+#define READ_KEYS 0x42 // Read the key-scan code
+#define NO_KEY 0xff    // Key-scan code when no key is pressed
 
 #define STARTADDR 0xc0
+#define GRIDS 6 // Display registers of the chip (GRID1~GRID6), whatever the module digits
 /*****Definitions for the clock point of the digit tube *******/
 #define POINT_ON 1
 #define POINT_OFF 0
@@ -48,6 +51,25 @@
 #define BRIGHT_DARKEST 0
 #define BRIGHT_TYPICAL 2
 #define BRIGHTEST 7
+/**************Definitions for the digit count*****************/
+// 4-digit (HH:MM) or 6-digit (HH:MM:SS) module, fixed at compile time.
+// Override with a build flag, e.g. -DTM1637_DIGITS=6
+#ifndef TM1637_DIGITS
+#define TM1637_DIGITS 4
+#endif
+#if TM1637_DIGITS != 4 && TM1637_DIGITS != 6
+#error "TM1637_DIGITS must be 4 or 6"
+#endif
+// Digits are written to GRID1~GRID6 in order, left to right. Some 6-digit modules wire the grids
+// in another order (e.g. 3,2,1,6,5,4): they aren't supported, as there is no grid map.
+// Digit whose bit 7 lights the clock point ":". The other digits keep theirs off, as they are the
+// decimal points of 6-digit modules. Override with a build flag, e.g. -DTM1637_POINT_DIGIT=3
+#ifndef TM1637_POINT_DIGIT
+#define TM1637_POINT_DIGIT 1
+#endif
+#if TM1637_POINT_DIGIT < 0 || TM1637_POINT_DIGIT >= TM1637_DIGITS
+#error "TM1637_POINT_DIGIT must be a digit of the module"
+#endif
 
 class TM1637 {
   public:
@@ -57,10 +79,15 @@ class TM1637 {
     boolean _PointFlag;            //_PointFlag=1:the clock point on
     TM1637(uint8_t, uint8_t);
     void init(void);               // To clear the display
+    void begin(const uint8_t SegData[]); // Clear the display and show a first frame in one transfer
     int writeByte(int8_t wr_data); // Write 8bit data to tm1637
     void start(void);              // Send start bits
     void stop(void);               // Send stop bits
     void display(int8_t DispData[]);
+    void displaySegments(const uint8_t SegData[], uint8_t *keys = nullptr); // Write encoded segments to full-screen in one transfer, and optionally read the keys
+    uint8_t readByte(void);        // Read 8bit data from tm1637
+    uint8_t readKeys(void);        // Read the key-scan code
+    static int8_t decodeKey(uint8_t code); // Key number (0~15) of a key-scan code, -1 if none
     void display(uint8_t BitAddr, int8_t DispData);
     void displayNum(float num, int decimal = 0, bool show_minus = true);
     void displayStr(char str[],  uint16_t loop_delay = 500);
@@ -69,11 +96,11 @@ class TM1637 {
     void point(boolean
                PointFlag);                                      //whether to light the clock point ":".To take effect the next time it displays.
     void coding(int8_t DispData[]);
-    int8_t coding(int8_t DispData);
+    int8_t coding(int8_t DispData, uint8_t BitAddr = TM1637_POINT_DIGIT); // Segments of a digit at BitAddr, with the clock point on its digit
     void bitDelay(void);
 
   private:
-    const int DIGITS = 4; // Number of digits on display
+    static const uint8_t DIGITS = TM1637_DIGITS; // Number of digits on display
     uint8_t clkpin;
     uint8_t datapin;
 };
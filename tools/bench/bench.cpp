@@ -0,0 +1,356 @@
+/// @file bench.cpp
+/// Host microbenchmarks of the clock hot paths, with a regression baseline.
+///
+/// Each benchmark reports the CPU time per call (ns/op, best of several runs) and the number of
+/// pin toggles per call on the emulated bus (see shim/Arduino.h). The toggles are deterministic,
+/// so any increase fails. The time depends on the host and its load, so it only fails past a
+/// tolerance: slower than `baseline * tolerance + slack`. The slack covers the noise of the shortest calls.
+///
+///     make run          # Build, run and compare with baseline.txt
+///     make baseline     # Rewrite baseline.txt with the current results
+///
+/// Or by hand: `./bench [--baseline FILE] [--write FILE] [--tolerance RATIO] [--slack NS] [--filter TEXT]`.
+
+// The TM1637 driver is built into this file, so the benchmarks can reach `char2segments()`,
+// which is internal to it.
+#include "../../src/tm1637.cpp"
+#include "../../src/clock.h"
+
+#include <algorithm>
+#include <chrono>
+#include <functional>
+#include <map>
+#include <memory>
+#include <string>
+#include <vector>
+
+uint8_t bench_levels[BENCH_PINS];
+uint32_t bench_toggles = 0;
+int64_t bench_us = 0;
+HardwareSerial Serial;
+Clock clk; // Target of the timer interrupt in clock.cpp, not used by the benchmarks
+
+#define CLK_PIN 5
+#define DIO_PIN 18
+#define BUZZER_PIN 12
+
+#define TOGGLE_CALLS 1000  ///< Calls over which the toggles per call are counted
+#define RUNS 5             ///< Timed runs per benchmark; the fastest one is reported
+#define RUN_NS 20000000.0  ///< Target duration of a timed run
+
+struct Result
+{
+    double ns;      ///< Nanoseconds per call
+    double toggles; ///< Pin toggles per call
+};
+
+/// @brief A benchmark: sets its fixture up, and returns the operation to time.
+struct Benchmark
+{
+    std::string name;
+    std::function<std::function<void()>()> setup;
+};
+
+/// @brief Fresh display and clock, as in `setup()` of the sketch, showing 12:34:56.
+struct Fixture
+{
+    TM1637 display{CLK_PIN, DIO_PIN};
+    Clock clock;
+
+    Fixture()
+    {
+        display.set(2);
+        display.point(POINT_OFF); // Zero in the firmware, where the display is a global
+        display.init();
+        clock.init(&display, BUZZER_PIN);
+        clock.handleSwitchAlarmChange(true);
+        clock.set_date(2024, 6, 15);
+        clock.set_time(12, 34, 56);
+        clock.set_alarm(7, 30);
+    }
+
+    void press(ButtonType button, uint8_t times = 1)
+    {
+        for (uint8_t i = 0; i < times; i++)
+        {
+            bench_us += 200000; // Presses 0.2 s apart
+            clock.press(button);
+        }
+    }
+};
+
+static std::unique_ptr<Fixture> fixture;
+
+static Fixture &fresh()
+{
+    fixture.reset(new Fixture());
+    return *fixture;
+}
+
+/// @brief The buttons to press from the clock state to reach each state.
+static void enter(Fixture &f, ClockState state)
+{
+    switch (state)
+    {
+    case STATE_CLOCK: break;
+    case STATE_MENU_SET: f.press(BUTTON_MENU); break;
+    case STATE_MENU_ALARM: f.press(BUTTON_MENU, 2); break;
+    case STATE_MENU_STOPWATCH: f.press(BUTTON_MENU, 3); break;
+    case STATE_MENU_COUNTDOWN: f.press(BUTTON_MENU, 4); break;
+    case STATE_SET_CLOCK: f.press(BUTTON_MENU); f.press(BUTTON_OK); break;
+    case STATE_SET_ALARM: f.press(BUTTON_MENU, 2); f.press(BUTTON_OK); break;
+    case STATE_ALARM_OFF: f.clock.handleSwitchAlarmChange(false); f.press(BUTTON_MENU, 2); f.press(BUTTON_OK); break;
+    case STATE_ALARM: f.clock.start_ringing(); break;
+    case STATE_STOPWATCH: f.press(BUTTON_MENU, 3); f.press(BUTTON_OK); f.press(BUTTON_OK); break; // Running
+    case STATE_COUNTDOWN: f.press(BUTTON_MENU, 4); f.press(BUTTON_OK); f.press(BUTTON_OK); break;  // Running
+    }
+}
+
+static const char *const STATE_NAMES[] = {
+    "clock", "menu_set", "menu_alarm", "menu_stopwatch", "menu_countdown", "set_clock",
+    "set_alarm", "alarm_off", "alarm", "stopwatch", "countdown",
+};
+
+static std::vector<Benchmark> benchmarks()
+{
+    std::vector<Benchmark> list;
+
+    list.push_back({"Clock::update_time", [] {
+        Fixture &f = fresh();
+        return [&f] { bench_us += 500000; f.clock.update_time(); };
+    }});
+    list.push_back({"Clock::set_temp_time", [] {
+        Fixture &f = fresh();
+        enter(f, STATE_SET_CLOCK);
+        return [&f] { f.clock.set_temp_time(1); };
+    }});
+    list.push_back({"Clock::commit_temp_time", [] {
+        Fixture &f = fresh();
+        enter(f, STATE_SET_CLOCK);
+        return [&f] { f.clock.commit_temp_time(); };
+    }});
+    for (uint8_t state = STATE_CLOCK; state <= STATE_COUNTDOWN; state++)
+    {
+        list.push_back({std::string("Clock::show/") + STATE_NAMES[state], [state] {
+            Fixture &f = fresh();
+            enter(f, (ClockState)state);
+            return [&f] { bench_us += 10000; f.clock.show(); };
+        }});
+    }
+    list.push_back({"TM1637::coding", [] {
+        Fixture &f = fresh();
+        return [&f] {
+            static const int8_t inputs[] = {0, 9, 0x0f, '5', 'A', 'n', '-', 0x7f};
+            static uint8_t i = 0;
+            volatile int8_t segments = f.display.coding(inputs[i++ & 7]);
+            (void)segments;
+        };
+    }});
+    list.push_back({"TM1637::coding/array", [] {
+        Fixture &f = fresh();
+        return [&f] {
+            int8_t digits[TM1637_DIGITS] = {};
+            digits[0] = 1;
+            digits[TM1637_DIGITS - 1] = 'E';
+            f.display.coding(digits);
+            volatile int8_t segments = digits[0];
+            (void)segments;
+        };
+    }});
+    list.push_back({"char2segments", [] {
+        return [] {
+            static const char text[] = "Alarm SEt StP Cnt OFF _^-*";
+            static uint8_t i = 0;
+            volatile uint8_t segments = char2segments(text[i]);
+            (void)segments;
+            i = (i + 1) % (sizeof(text) - 1);
+        };
+    }});
+    list.push_back({"TM1637::display", [] {
+        Fixture &f = fresh();
+        return [&f] {
+            int8_t digits[TM1637_DIGITS];
+            for (uint8_t i = 0; i < TM1637_DIGITS; i++)
+            {
+                digits[i] = (i * 3 + 1) % 10;
+            }
+            f.display.display(digits);
+        };
+    }});
+    list.push_back({"TM1637::displayStr", [] {
+        Fixture &f = fresh();
+        return [&f] {
+            char text[] = "SEt";
+            f.display.displayStr(text);
+        };
+    }});
+    list.push_back({"TM1637::displayStr/scroll", [] {
+        Fixture &f = fresh();
+        return [&f] {
+            char text[] = "ALArM";
+            f.display.displayStr(text, 0);
+        };
+    }});
+    return list;
+}
+
+static Result measure(const Benchmark &benchmark)
+{
+    Result result;
+
+    memset(bench_levels, HIGH, sizeof(bench_levels)); // Idle bus, so the count doesn't depend on the previous benchmark
+    std::function<void()> op = benchmark.setup();      // Count the toggles from a fresh fixture
+    uint32_t toggles = bench_toggles;
+    for (int i = 0; i < TOGGLE_CALLS; i++)
+    {
+        op();
+    }
+    result.toggles = (double)(bench_toggles - toggles) / TOGGLE_CALLS;
+
+    op = benchmark.setup();
+    uint64_t calls = 1;
+    for (;;) // Calibrate the number of calls per run
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < calls; i++)
+        {
+            op();
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        if (ns > RUN_NS / 10)
+        {
+            calls = std::max<uint64_t>(1, calls * RUN_NS / ns);
+            break;
+        }
+        calls *= 10;
+    }
+
+    result.ns = 1e300;
+    for (int run = 0; run < RUNS; run++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        for (uint64_t i = 0; i < calls; i++)
+        {
+            op();
+        }
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        result.ns = std::min(result.ns, ns / calls);
+    }
+    fixture.reset();
+    return result;
+}
+
+/// @brief Read a baseline file: one `name ns_per_op toggles_per_call` line per benchmark, `#` comments.
+static std::map<std::string, Result> read_baseline(const char *path)
+{
+    std::map<std::string, Result> baseline;
+    FILE *file = fopen(path, "r");
+    if (!file)
+    {
+        perror(path);
+        exit(2);
+    }
+    char line[256], name[128];
+    Result result;
+    while (fgets(line, sizeof(line), file))
+    {
+        if (line[0] != '#' && sscanf(line, "%127s %lf %lf", name, &result.ns, &result.toggles) == 3)
+        {
+            baseline[name] = result;
+        }
+    }
+    fclose(file);
+    return baseline;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *baseline_path = nullptr;
+    const char *write_path = nullptr;
+    const char *filter = "";
+    double tolerance = 1.5;
+    double slack = 20;
+    for (int i = 1; i < argc; i++)
+    {
+        std::string arg = argv[i];
+        if (arg == "--baseline" && i + 1 < argc)
+            baseline_path = argv[++i];
+        else if (arg == "--write" && i + 1 < argc)
+            write_path = argv[++i];
+        else if (arg == "--tolerance" && i + 1 < argc)
+            tolerance = atof(argv[++i]);
+        else if (arg == "--slack" && i + 1 < argc)
+            slack = atof(argv[++i]);
+        else if (arg == "--filter" && i + 1 < argc)
+            filter = argv[++i];
+        else
+        {
+            fprintf(stderr, "usage: %s [--baseline FILE] [--write FILE] [--tolerance RATIO] [--slack NS] [--filter TEXT]\n", argv[0]);
+            return 2;
+        }
+    }
+
+    std::map<std::string, Result> baseline;
+    if (baseline_path)
+    {
+        baseline = read_baseline(baseline_path);
+    }
+    FILE *out = nullptr;
+    if (write_path && !(out = fopen(write_path, "w")))
+    {
+        perror(write_path);
+        return 2;
+    }
+    if (out)
+    {
+        fprintf(out, "# Generated by `make baseline` (TM1637_DIGITS=%d). Columns: benchmark, ns/op, pin toggles/call.\n", TM1637_DIGITS);
+    }
+
+    int failures = 0;
+    printf("%-32s %10s %10s %10s %12s  %s\n", "benchmark", "ns/op", "base", "toggles", "base", "");
+    for (const Benchmark &benchmark : benchmarks())
+    {
+        if (benchmark.name.find(filter) == std::string::npos)
+        {
+            continue;
+        }
+        Result result = measure(benchmark);
+        if (out)
+        {
+            fprintf(out, "%-32s %10.1f %10.2f\n", benchmark.name.c_str(), result.ns, result.toggles);
+        }
+
+        auto found = baseline.find(benchmark.name);
+        if (found == baseline.end())
+        {
+            printf("%-32s %10.1f %10s %10.2f %12s  %s\n", benchmark.name.c_str(), result.ns, "-", result.toggles, "-",
+                   baseline_path ? "NEW" : "");
+            continue;
+        }
+        const Result &base = found->second;
+        const char *verdict = "ok";
+        if (result.toggles > base.toggles + 0.005)
+        {
+            verdict = "FAIL: more bus traffic";
+            failures++;
+        }
+        else if (result.ns > base.ns * tolerance + slack)
+        {
+            verdict = "FAIL: slower";
+            failures++;
+        }
+        printf("%-32s %10.1f %10.1f %10.2f %12.2f  %s\n", benchmark.name.c_str(), result.ns, base.ns, result.toggles,
+               base.toggles, verdict);
+    }
+
+    if (out)
+    {
+        fclose(out);
+    }
+    if (failures)
+    {
+        printf("\n%d benchmark(s) regressed against %s (time tolerance x%.2f + %.0f ns)\n", failures, baseline_path, tolerance, slack);
+        return 1;
+    }
+    return 0;
+}
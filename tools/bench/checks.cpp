@@ -0,0 +1,392 @@
+/// @file checks.cpp
+/// Host checks of the clock behavior, on the emulated Arduino core (see shim/Arduino.h).
+///
+/// Built once per execution model, like the firmware: `checks` with the periodic timer, and
+/// `checks_lowpower` with `CLOCK_LOW_POWER`, where the CPU wake-up rate is checked. The time only
+/// advances when a check moves `bench_us`, or when the clock sleeps (see shim/esp_sleep.h).
+///
+///     make check
+#include "clock.h"
+
+#include <cstddef>
+#include <string>
+#include <vector>
+
+#if CLOCK_LOW_POWER
+#include "esp_sleep.h"
+#endif
+
+uint8_t bench_levels[BENCH_PINS];
+uint32_t bench_toggles = 0;
+int64_t bench_us = 0;
+HardwareSerial Serial;
+Clock clk; // Target of the timer interrupt in clock.cpp, not used by the checks
+
+#define CLK_PIN 5
+#define DIO_PIN 18
+#define BUZZER_PIN 12
+
+#define HOUR_US 3600000000LL
+
+static int failures = 0;
+
+static void expect(bool ok, const std::string &what)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what.c_str());
+        failures++;
+    }
+}
+
+/// @brief Fresh display and clock, as in `setup()` of the sketch, running at 12:34:56.
+struct Fixture
+{
+    TM1637 display{CLK_PIN, DIO_PIN};
+    Clock clock;
+    int64_t press_us = 0; ///< Time of the last press
+
+    Fixture()
+    {
+        display.set(2);
+        clock.init(&display, BUZZER_PIN);
+        clock.handleSwitchAlarmChange(true);
+        clock.set_date(2024, 6, 15);
+        clock.set_time(12, 34, 56);
+        clock.show_first_frame();
+        clock.run();
+    }
+
+    void press(ButtonType button, uint8_t times = 1)
+    {
+        for (uint8_t i = 0; i < times; i++)
+        {
+            bench_us += 200000; // Presses 0.2 s apart
+            press_us = bench_us;
+            clock.press(button);
+#if CLOCK_LOW_POWER
+            bench_wakeup = true; // The button wakes the CPU up, and `loop()` handles the press
+            clock.sleep_until_next_deadline();
+#endif
+        }
+    }
+};
+
+/// @brief Let the clock run: timer ticks, or sleeps until the next deadline in the low-power mode.
+/// @param us Microseconds to run for.
+static void run_for(Fixture &f, int64_t us)
+{
+    int64_t end = bench_us + us;
+    while (bench_us < end)
+    {
+#if CLOCK_LOW_POWER
+        f.clock.sleep_until_next_deadline();
+#else
+        bench_us += 500000;
+        f.clock.tick();
+#endif
+    }
+}
+
+/// @brief Whether the alarm rings, i.e. the next frame sounds the buzzer.
+static bool ringing(Fixture &f)
+{
+    Frame frame;
+    f.clock.compose(frame);
+    return frame.ringing;
+}
+
+/// @brief Timers expire on their tick, and `ticks_to_next()` never skips past one, whatever the
+///        level they wait in. The low-power mode sleeps for `ticks_to_next()`.
+static void check_timer_wheel()
+{
+    static const uint32_t STARTS[] = {0, 1, 63, 64, 4095, 4096, 4097, 100000};
+    static const uint32_t DELAYS[] = {1, 2, 63, 64, 65, 4000, 4095, 4096, 4097, 200000, TimerWheel::MAX_TICKS};
+    for (uint32_t start : STARTS)
+    {
+        for (uint32_t delay : DELAYS)
+        {
+            TimerWheel wheel;
+            for (uint32_t i = 0; i < start; i++)
+            {
+                wheel.tick();
+            }
+            uint32_t fired = 0;
+            WheelTimer timer;
+            wheel.schedule(timer, delay, [](void *fired) { *(uint32_t *)fired += 1; }, &fired);
+
+            std::string what = "timer of " + std::to_string(delay) + " ticks from tick " + std::to_string(start);
+            uint32_t elapsed = 0;
+            while (!fired && elapsed < delay)
+            {
+                uint32_t next = wheel.ticks_to_next();
+                if (next == 0 || next > delay - elapsed)
+                {
+                    expect(false, what + ": next timer in " + std::to_string(next) + " ticks, " +
+                                      std::to_string(delay - elapsed) + " left");
+                    break;
+                }
+                for (uint32_t i = 0; i < next && !fired; i++, elapsed++)
+                {
+                    wheel.tick();
+                }
+            }
+            expect(fired == 1 && elapsed == delay, what + ": fired after " + std::to_string(elapsed) + " ticks");
+            expect(wheel.ticks_to_next() == UINT32_MAX, what + ": still pending");
+        }
+    }
+}
+
+/// @brief A snoozed alarm rings again after the snooze interval, unless the alarm switch was turned off.
+static void check_snooze()
+{
+    for (bool switch_on : {true, false})
+    {
+        Fixture f;
+        f.clock.start_ringing();
+        f.clock.press(BUTTON_MENU); // Snooze
+        run_for(f, 1000000);
+        expect(!ringing(f), "snooze stops the alarm");
+        f.clock.handleSwitchAlarmChange(switch_on);
+        run_for(f, DEFAULT_SNOOZE_MINUTES * 60000000LL + 1000000);
+        expect(ringing(f) == switch_on, switch_on ? "snoozed alarm rings again" : "snoozed alarm rings with the switch off");
+    }
+}
+
+/// @brief The buzzer stops on every way out of the ringing alarm: timeout, snooze and OK.
+static void check_buzzer_stops()
+{
+    static const char *const WAYS[] = {"timeout", "snooze", "OK"};
+    for (int way = 0; way < 3; way++)
+    {
+        Fixture f;
+        f.clock.start_ringing();
+        run_for(f, 1000000);
+        expect(f.clock.buzzing(), std::string("buzzer sounds before the ") + WAYS[way]);
+        if (way == 0)
+        {
+            run_for(f, RING_TICKS * 500000LL);
+        }
+        else
+        {
+            f.press(way == 1 ? BUTTON_MENU : BUTTON_OK);
+        }
+        run_for(f, 1000000);
+        expect(!ringing(f) && !f.clock.buzzing(), std::string("buzzer stops after the ") + WAYS[way]);
+    }
+}
+
+/// @brief Whether the clock shows these digits now, with the colon on.
+static bool shows(Fixture &f, const std::vector<int8_t> &digits)
+{
+    Frame frame;
+    f.clock.compose(frame);
+    f.display.point(POINT_ON);
+    for (uint8_t i = 0; i < TM1637_DIGITS; i++)
+    {
+        if (frame.segments[i] != (uint8_t)f.display.coding(digits[i], i))
+        {
+            return false;
+        }
+    }
+    return true;
+}
+
+/// @brief The stopwatch switches to h:mm from 100 minutes, and stays at 99:59 past 99 hours.
+static void check_stopwatch_display()
+{
+    Fixture f;
+    f.press(BUTTON_MENU, 3);
+    f.press(BUTTON_OK, 2); // Start the stopwatch
+#if TM1637_DIGITS == 6
+    const std::vector<int8_t> under = {9, 9, 5, 9, 0, 0}, over = {0x7f, 1, 4, 0, 0, 0}, clamped = {9, 9, 5, 9, 5, 9};
+#else
+    const std::vector<int8_t> under = {9, 9, 5, 9}, over = {0x7f, 1, 4, 0}, clamped = {9, 9, 5, 9};
+#endif
+    int64_t start = f.press_us;
+    bench_us = start + (99 * 60 + 59) * 1000000LL;
+    expect(shows(f, under), "stopwatch at 99:59 shows MM:SS");
+    bench_us = start + 100 * 60000000LL;
+    expect(shows(f, over), "stopwatch at 100 minutes shows h:mm");
+    bench_us = start + 150 * 3600000000LL;
+    expect(shows(f, clamped), "stopwatch past 99 hours stays at 99:59");
+}
+
+/// @brief The end of a countdown rings, and the menu button stops it without a snooze.
+static void check_countdown_ring()
+{
+    Fixture f;
+    f.press(BUTTON_MENU, 4);
+    f.press(BUTTON_OK, 2); // Start the countdown
+    run_for(f, DEFAULT_COUNTDOWN_MINUTES * 60000000LL + 1000000);
+    expect(ringing(f), "countdown rings at zero");
+    f.clock.press(BUTTON_MENU);
+    run_for(f, 1000000);
+    expect(!ringing(f), "menu button stops the countdown ring");
+    run_for(f, DEFAULT_SNOOZE_MINUTES * 60000000LL + 1000000);
+    expect(!ringing(f), "countdown ring snoozed");
+}
+
+/// @brief With the snooze disabled, the menu button stops the alarm like OK.
+static void check_snooze_disabled()
+{
+    Fixture f;
+    f.clock.set_snooze(0);
+    f.clock.start_ringing();
+    run_for(f, 1000000);
+    f.press(BUTTON_MENU);
+    run_for(f, 1000000);
+    expect(!ringing(f) && !f.clock.buzzing(), "menu button stops the alarm with the snooze disabled");
+    run_for(f, RING_TICKS * 500000LL);
+    expect(!ringing(f), "alarm rings again with the snooze disabled");
+}
+
+/// @brief Every menu returns to the clock after `MENU_TIMEOUT_TICKS` without a button press.
+static void check_menu_timeout()
+{
+    struct Path
+    {
+        uint8_t menu, ok;
+        ClockState state;
+    };
+    static const Path PATHS[] = {
+        {1, 0, STATE_MENU_SET},       {2, 0, STATE_MENU_ALARM}, {3, 0, STATE_MENU_STOPWATCH},
+        {4, 0, STATE_MENU_COUNTDOWN}, {1, 1, STATE_SET_CLOCK},  {2, 1, STATE_SET_ALARM},
+    };
+    for (const Path &path : PATHS)
+    {
+        Fixture f;
+        f.press(BUTTON_MENU, path.menu);
+        f.press(BUTTON_OK, path.ok);
+        std::string what = "menu state " + std::to_string(path.state);
+        expect(f.clock.current_state() == path.state, what + " reached");
+        run_for(f, (MENU_TIMEOUT_TICKS - 2) * 500000LL);
+        expect(f.clock.current_state() == path.state, what + " left before the timeout");
+        run_for(f, 2000000);
+        expect(f.clock.current_state() == STATE_CLOCK, what + " returns to the clock after the timeout");
+    }
+}
+
+/// @brief Time corrections apply in full, down to the microsecond: decades (from the boot time in 1970)
+///        and seconds are stepped, with the sub-millisecond rest slewed, and smaller ones slewed.
+static void check_adjust()
+{
+    static const int64_t OFFSETS[] = {1700000000123456LL, -1700000000123456LL, 2500000, -1234567891, 1234, -999};
+    for (int64_t offset : OFFSETS)
+    {
+        Fixture f;
+        int64_t start = bench_us, before = f.clock.utc_us(start);
+        f.clock.adjust(offset);
+        run_for(f, 5000000);
+        int64_t error = f.clock.utc_us(bench_us) - (before + (bench_us - start) + offset);
+        expect(error == 0, "adjust by " + std::to_string(offset) + " us: off by " + std::to_string(error) + " us");
+    }
+}
+
+/// @brief CRC-32 as zlib, to sign modified bundles.
+static uint32_t crc32(const uint8_t *data, uint32_t size)
+{
+    uint32_t crc = 0xffffffff;
+    for (uint32_t i = 0; i < size; i++)
+    {
+        crc ^= data[i];
+        for (int bit = 0; bit < 8; bit++)
+        {
+            crc = crc >> 1 ^ (crc & 1 ? 0xedb88320 : 0);
+        }
+    }
+    return ~crc;
+}
+
+/// @brief A section past the end of the bundle is rejected, even when its end wraps around 32 bits.
+static void check_bundle_bounds()
+{
+    static const uint32_t OFFSETS[] = {0xfffffff0, 0xffffff00, DEFAULT_BUNDLE_SIZE};
+    for (uint32_t offset : OFFSETS)
+    {
+        alignas(4) uint8_t data[512];
+        memcpy(data, DEFAULT_BUNDLE, DEFAULT_BUNDLE_SIZE);
+        BundleHeader *header = (BundleHeader *)data;
+        BundleSection *sections = (BundleSection *)(data + sizeof(BundleHeader));
+        sections[SECTION_MELODY].offset = offset;
+        const uint32_t checked = offsetof(BundleHeader, crc32) + sizeof(header->crc32);
+        header->crc32 = crc32(data + checked, header->size - checked);
+
+        ConfigBundle bundle;
+        expect(!bundle.attach(data, sizeof(data)), "bundle with the melody at " + std::to_string(offset) + " rejected");
+    }
+}
+
+#if CLOCK_LOW_POWER
+/// @brief Average wake-ups per hour over three hours in the clock state.
+/// @param colon_blink Whether the colon blinks.
+static uint32_t wakeup_rate(bool colon_blink)
+{
+    Fixture f;
+    f.clock.set_colon_blink(colon_blink);
+    int64_t end = bench_us + 3 * HOUR_US;
+    while (bench_us < end)
+    {
+        f.clock.sleep_until_next_deadline();
+    }
+    return f.clock.wakeups_per_hour();
+}
+
+/// @brief The CPU only wakes up when the display changes: on minute rollovers with a steady
+///        colon (second rollovers on 6-digit modules), every 0.5 seconds with a blinking one.
+static void check_wakeup_rate()
+{
+    uint32_t steady = wakeup_rate(false);
+    uint32_t expected = TM1637_DIGITS == 6 ? 3600 : 60;
+    expect(steady >= expected - 1 && steady <= expected + 1,
+           "wake-ups/h with a steady colon: " + std::to_string(steady) + ", expected " + std::to_string(expected));
+
+    uint32_t blinking = wakeup_rate(true);
+    expect(blinking >= 7199 && blinking <= 7201, "wake-ups/h with a blinking colon: " + std::to_string(blinking) + ", expected 7200");
+}
+#endif
+
+#if CLOCK_LOW_POWER
+/// @brief A countdown running behind the clock with a steady colon rings on time, although the
+///        CPU only wakes up on minute rollovers for the display.
+static void check_countdown_wakeup()
+{
+    Fixture f;
+    f.clock.set_colon_blink(false);
+    f.press(BUTTON_MENU, 4);
+    f.press(BUTTON_OK, 2); // Start the countdown
+    int64_t end = f.press_us + DEFAULT_COUNTDOWN_MINUTES * 60000000LL;
+    f.press(BUTTON_MENU); // Back to the clock, the countdown keeps running
+    while (!ringing(f) && bench_us < end + 60000000LL)
+    {
+        f.clock.sleep_until_next_deadline();
+    }
+    int64_t late = bench_us - end;
+    expect(ringing(f) && late >= 0 && late < 1000, "countdown behind the clock rings " + std::to_string(late) + " us late");
+}
+#endif
+
+int main()
+{
+    check_timer_wheel();
+    check_snooze();
+    check_buzzer_stops();
+    check_stopwatch_display();
+    check_countdown_ring();
+    check_snooze_disabled();
+    check_menu_timeout();
+    check_adjust();
+    check_bundle_bounds();
+#if CLOCK_LOW_POWER
+    check_countdown_wakeup();
+    check_wakeup_rate();
+#endif
+
+    if (failures)
+    {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("clock%s: all checks passed\n", CLOCK_LOW_POWER ? " (low-power)" : "");
+    return 0;
+}
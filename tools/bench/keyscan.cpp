@@ -0,0 +1,229 @@
+/// @file keyscan.cpp
+/// Host check of the TM1637 key-scan read, against a model of the chip decoding the bus.
+///
+/// The model follows the two-wire protocol of the datasheet: start and stop conditions, bytes
+/// sampled LSB first on the rising clock edge, the ACK driven low on the ninth clock, and after the
+/// read command (0x42) the key-scan code shifted out on the falling clock edges. It records every
+/// transaction, so the check verifies both the decoded keys and the bytes sent for each refresh,
+/// and that the first frame (`TM1637::begin()`) goes out in a single transfer.
+///
+///     make check
+#include "tm1637.h"
+
+#include <string>
+#include <vector>
+
+BenchBus *bench_bus;
+uint8_t bench_levels[BENCH_PINS];
+uint32_t bench_toggles = 0;
+int64_t bench_us = 0;
+HardwareSerial Serial;
+
+#define CLK_PIN 5
+#define DIO_PIN 18
+
+/// @brief Model of the TM1637 side of the bus.
+class Tm1637Model : public BenchBus
+{
+public:
+    uint8_t code = NO_KEY;                         ///< Key-scan code to send
+    std::vector<std::vector<uint8_t>> transactions; ///< Bytes written in each start...stop transaction
+    std::vector<uint8_t> reads;                     ///< Bytes read by the host
+    bool errors = false;                            ///< Protocol errors, e.g. a byte cut short
+
+    void mode(uint8_t pin, uint8_t mode) override
+    {
+        if (pin == DIO_PIN)
+        {
+            bool before = line();
+            host_drives = mode == OUTPUT;
+            data_changed(before);
+        }
+    }
+
+    void write(uint8_t pin, uint8_t level) override
+    {
+        if (pin == DIO_PIN)
+        {
+            bool before = line();
+            host_level = level;
+            data_changed(before);
+        }
+        else if (pin == CLK_PIN && level != clk)
+        {
+            clk = level;
+            clk ? rising() : falling();
+        }
+    }
+
+    int read(uint8_t pin) override { return pin == DIO_PIN ? line() : clk; }
+
+private:
+    bool clk = true;
+    bool host_drives = true;
+    bool host_level = true;
+    bool chip_low = false;   ///< The chip pulls the data line low (ACK or a 0 bit)
+    bool active = false;     ///< Between start and stop
+    bool reading = false;    ///< Shifting the key-scan code out
+    uint8_t bits = 0;        ///< Bits of the current byte
+    uint8_t byte = 0;
+
+    bool line() const { return (!host_drives || host_level) && !chip_low; } // Open drain with a pull-up
+
+    void data_changed(bool before)
+    {
+        bool now = line();
+        if (!clk || now == before)
+        {
+            return;
+        }
+        if (!now) // Falling data with the clock high: start
+        {
+            active = true;
+            reading = false;
+            bits = 0;
+            transactions.push_back({});
+        }
+        else // Rising data with the clock high: stop
+        {
+            if (active && bits > 1 && bits < 8) // The stop condition itself clocks one bit in
+            {
+                errors = true;
+            }
+            active = false;
+        }
+    }
+
+    void rising()
+    {
+        if (!active || reading || bits >= 8)
+        {
+            return;
+        }
+        byte |= line() << bits;
+        if (++bits == 8)
+        {
+            transactions.back().push_back(byte);
+        }
+    }
+
+    void falling()
+    {
+        if (!active)
+        {
+            return;
+        }
+        chip_low = false;
+        if (bits == 8) // Ninth clock: ACK
+        {
+            chip_low = true;
+            bits = 9;
+            return;
+        }
+        if (bits == 9) // After the ACK
+        {
+            bits = 0;
+            byte = 0;
+            if (transactions.back().size() == 1 && transactions.back()[0] == READ_KEYS && !reading)
+            {
+                reading = true;
+            }
+            else if (reading) // ACK clock of the code: the code is complete
+            {
+                reading = false;
+                bits = 9;
+                return;
+            }
+        }
+        if (reading) // Shift the next bit of the code out, LSB first
+        {
+            chip_low = !(code >> bits & 1);
+            if (++bits == 8)
+            {
+                reads.push_back(code);
+            }
+        }
+    }
+};
+
+static int failures = 0;
+
+static void expect(bool ok, const std::string &what)
+{
+    if (!ok)
+    {
+        printf("FAIL: %s\n", what.c_str());
+        failures++;
+    }
+}
+
+int main()
+{
+    Tm1637Model chip;
+    bench_bus = &chip;
+    TM1637 display(CLK_PIN, DIO_PIN);
+    display.set(2);
+    display.point(POINT_OFF);
+
+    // Every key of the matrix, and no key
+    for (int key = -1; key < 16; key++)
+    {
+        chip.code = key < 0 ? NO_KEY : key < 8 ? 0xf7 - key : 0xef - (key - 8);
+        chip.transactions.clear();
+        uint8_t code = display.readKeys();
+        char what[64];
+        snprintf(what, sizeof(what), "key %d: read 0x%02x, sent 0x%02x", key, code, chip.code);
+        expect(code == chip.code, what);
+        expect(TM1637::decodeKey(code) == key, std::string(what) + ", decoded");
+        expect(chip.transactions.size() == 1 && chip.transactions[0] == std::vector<uint8_t>{READ_KEYS},
+               std::string(what) + ", one read command");
+    }
+
+    // Invalid codes
+    for (int code = 0; code < 0x100; code++)
+    {
+        bool valid = (code >= 0xe8 && code <= 0xf7);
+        if (!valid)
+        {
+            expect(TM1637::decodeKey(code) == -1, "invalid code " + std::to_string(code) + " decoded as a key");
+        }
+    }
+
+    // Key read folded into a refresh: the segment transactions are unchanged, followed by the read
+    uint8_t segments[TM1637_DIGITS];
+    for (uint8_t i = 0; i < TM1637_DIGITS; i++)
+    {
+        segments[i] = 0x3f + i;
+    }
+    chip.code = 0xf5; // SG3, K1
+    chip.transactions.clear();
+    uint8_t keys = 0;
+    display.displaySegments(segments, &keys);
+    std::vector<uint8_t> data = {STARTADDR};
+    data.insert(data.end(), segments, segments + TM1637_DIGITS);
+    std::vector<std::vector<uint8_t>> expected = {{ADDR_AUTO}, data, {0x8a}, {READ_KEYS}};
+    expect(chip.transactions == expected, "refresh transactions");
+    expect(keys == 0xf5 && TM1637::decodeKey(keys) == 2, "key read with the refresh");
+
+    // Without a key pointer, the refresh doesn't read the keys
+    chip.transactions.clear();
+    display.displaySegments(segments);
+    expected.pop_back();
+    expect(chip.transactions == expected, "refresh without a key read");
+
+    // First frame: the frame and the clearing of all the display registers in a single transfer
+    chip.transactions.clear();
+    display.begin(segments);
+    data.resize(1 + GRIDS, 0x00);
+    expected = {{ADDR_AUTO}, data, {0x8a}};
+    expect(chip.transactions == expected, "first frame transactions");
+
+    expect(!chip.errors, "bus protocol errors");
+    if (failures)
+    {
+        printf("%d check(s) failed\n", failures);
+        return 1;
+    }
+    printf("key-scan: all checks passed\n");
+    return 0;
+}
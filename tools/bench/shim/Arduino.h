@@ -0,0 +1,119 @@
+/// @file Arduino.h
+/// Host emulation of the Arduino core functions used by the clock, for the benchmarks.
+///
+/// Pin writes are recorded instead of driving hardware: `bench_toggles` counts the writes that
+/// change the level of a pin, i.e. the edges a logic analyzer would see on the bus.
+/// Built with `BENCH_BUS`, a device model can be attached to the pins through `bench_bus` (see keyscan.cpp).
+/// The benchmarks are built without it, so the emulation adds as little as possible to the timings.
+/// Delays return immediately, so the benchmarks measure the CPU time only; they advance the emulated
+/// time (`bench_us`), which the checks rely on (see checks.cpp).
+#ifndef BENCH_ARDUINO_H
+#define BENCH_ARDUINO_H
+
+#include <cmath>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include "esp_attr.h"
+
+typedef bool boolean;
+
+#define HIGH 1
+#define LOW 0
+#define INPUT 0x01
+#define OUTPUT 0x03
+#define INPUT_PULLUP 0x05
+#define FALLING 0x02
+#define CHANGE 0x03
+#define ARDUINO_ISR_ATTR
+
+#define BENCH_PINS 40 ///< GPIOs of the ESP32
+
+#ifdef BENCH_BUS
+/// @brief A device connected to the emulated pins.
+struct BenchBus
+{
+    virtual void mode(uint8_t pin, uint8_t mode) = 0;
+    virtual void write(uint8_t pin, uint8_t level) = 0;
+    virtual int read(uint8_t pin) = 0;
+};
+
+extern BenchBus *bench_bus; ///< Device on the pins
+#endif
+
+extern uint8_t bench_levels[BENCH_PINS];
+extern uint32_t bench_toggles;
+extern int64_t bench_us;
+
+#ifdef BENCH_BUS
+inline void pinMode(uint8_t pin, uint8_t mode) { bench_bus->mode(pin, mode); }
+inline void digitalWrite(uint8_t pin, uint8_t level)
+{
+    bench_levels[pin] = level;
+    bench_bus->write(pin, level);
+}
+inline int digitalRead(uint8_t pin) { return bench_bus->read(pin); }
+#else
+inline void pinMode(uint8_t, uint8_t) {}
+inline void digitalWrite(uint8_t pin, uint8_t level)
+{
+    if (bench_levels[pin] != level)
+    {
+        bench_levels[pin] = level;
+        bench_toggles++;
+    }
+}
+inline int digitalRead(uint8_t) { return LOW; } // The TM1637 always acknowledges
+#endif
+inline void delay(uint32_t ms) { bench_us += ms * 1000LL; }
+inline void delayMicroseconds(uint32_t) {}
+inline unsigned long millis() { return bench_us / 1000; }
+inline unsigned long micros() { return bench_us; }
+inline void tone(uint8_t, unsigned int, unsigned long = 0) {}
+inline void noTone(uint8_t) {}
+
+// FreeRTOS tasks aren't emulated: they are created, but never run.
+typedef int BaseType_t;
+typedef uint32_t TickType_t;
+typedef void *TaskHandle_t;
+#define pdFALSE 0
+#define pdTRUE 1
+#define portMAX_DELAY UINT32_MAX
+#define configMAX_PRIORITIES 25
+#define pdMS_TO_TICKS(ms) (ms)
+#define portYIELD_FROM_ISR(woken) (void)(woken)
+inline BaseType_t xTaskCreate(void (*)(void *), const char *, uint32_t, void *, uint32_t, TaskHandle_t *task)
+{
+    *task = nullptr;
+    return pdTRUE;
+}
+inline uint32_t ulTaskNotifyTake(BaseType_t, TickType_t) { return 0; }
+inline BaseType_t xTaskNotifyGive(TaskHandle_t) { return pdTRUE; }
+inline void vTaskNotifyGiveFromISR(TaskHandle_t, BaseType_t *) {}
+inline BaseType_t xPortInIsrContext() { return pdFALSE; }
+
+struct hw_timer_t;
+inline hw_timer_t *timerBegin(uint8_t, uint16_t, bool) { return nullptr; }
+inline void timerAttachInterrupt(hw_timer_t *, void (*)(), bool) {}
+inline void timerAlarmWrite(hw_timer_t *, uint64_t, bool) {}
+inline void timerAlarmEnable(hw_timer_t *) {}
+
+struct Stream
+{
+    int available() { return 0; }
+    int read() { return -1; }
+    size_t printf(const char *, ...) { return 0; }
+};
+
+struct HardwareSerial : Stream
+{
+    void begin(unsigned long) {}
+    void flush() {}
+    template <class T> size_t print(T) { return 0; }
+    template <class T> size_t println(T) { return 0; }
+};
+
+extern HardwareSerial Serial;
+
+#endif
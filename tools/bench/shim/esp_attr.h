@@ -0,0 +1,9 @@
+/// @file esp_attr.h
+/// Host emulation of the ESP-IDF placement attributes. There is no IRAM on the host.
+#ifndef BENCH_ESP_ATTR_H
+#define BENCH_ESP_ATTR_H
+
+#define IRAM_ATTR
+#define DRAM_ATTR
+
+#endif
@@ -0,0 +1,24 @@
+/// @file esp_partition.h
+/// Host emulation of the ESP-IDF partition API. There is no `config` partition, so the
+/// benchmarks run with the built-in configuration bundle.
+#ifndef BENCH_ESP_PARTITION_H
+#define BENCH_ESP_PARTITION_H
+
+#include <cstddef>
+#include <cstdint>
+
+typedef int esp_err_t;
+#define ESP_OK 0
+#define ESP_FAIL -1
+
+typedef enum { ESP_PARTITION_TYPE_APP = 0, ESP_PARTITION_TYPE_DATA = 1 } esp_partition_type_t;
+typedef int esp_partition_subtype_t;
+typedef struct { uint32_t address; uint32_t size; } esp_partition_t;
+typedef uint32_t spi_flash_mmap_handle_t;
+typedef enum { SPI_FLASH_MMAP_DATA, SPI_FLASH_MMAP_INST } spi_flash_mmap_memory_t;
+
+inline const esp_partition_t *esp_partition_find_first(esp_partition_type_t, esp_partition_subtype_t, const char *) { return nullptr; }
+inline esp_err_t esp_partition_mmap(const esp_partition_t *, size_t, size_t, spi_flash_mmap_memory_t, const void **, spi_flash_mmap_handle_t *) { return ESP_FAIL; }
+inline void spi_flash_munmap(spi_flash_mmap_handle_t) {}
+
+#endif
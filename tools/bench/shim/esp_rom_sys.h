@@ -0,0 +1,10 @@
+/// @file esp_rom_sys.h
+/// Host emulation of the ESP32 ROM delay: returns immediately, like `delayMicroseconds()` in Arduino.h.
+#ifndef BENCH_ESP_ROM_SYS_H
+#define BENCH_ESP_ROM_SYS_H
+
+#include <cstdint>
+
+inline void esp_rom_delay_us(uint32_t) {}
+
+#endif
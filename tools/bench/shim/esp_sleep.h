@@ -0,0 +1,29 @@
+/// @file esp_sleep.h
+/// Host emulation of the ESP-IDF sleep functions: light sleep returns immediately, with the
+/// emulated time (`bench_us`) advanced to the timer wake-up, or not at all when a GPIO wake-up is pending.
+#ifndef BENCH_ESP_SLEEP_H
+#define BENCH_ESP_SLEEP_H
+
+#include <cstdint>
+
+extern int64_t bench_us;
+inline uint64_t bench_sleep_us = 0; ///< Timer wake-up of the next light sleep
+inline bool bench_wakeup = false;   ///< A GPIO wake-up (button) is pending: the next light sleep ends at once
+
+inline int esp_sleep_enable_timer_wakeup(uint64_t us)
+{
+    bench_sleep_us = us;
+    return 0;
+}
+inline int esp_sleep_enable_gpio_wakeup() { return 0; }
+inline int esp_light_sleep_start()
+{
+    if (!bench_wakeup)
+    {
+        bench_us += bench_sleep_us;
+    }
+    bench_wakeup = false;
+    return 0;
+}
+
+#endif
@@ -0,0 +1,10 @@
+/// @file esp_timer.h
+/// Host emulation of the ESP-IDF microsecond counter. The benchmarks advance `bench_us` by hand.
+#ifndef BENCH_ESP_TIMER_H
+#define BENCH_ESP_TIMER_H
+
+#include "Arduino.h"
+
+inline int64_t esp_timer_get_time() { return bench_us; }
+
+#endif
@@ -0,0 +1,31 @@
+/// @file gpio_ll.h
+/// Host emulation of the ESP-IDF GPIO register functions, on the emulated pins of Arduino.h: the
+/// writes are counted and reach the device model like `digitalWrite()`.
+#ifndef BENCH_GPIO_LL_H
+#define BENCH_GPIO_LL_H
+
+#include "Arduino.h"
+
+typedef int gpio_num_t;
+typedef enum
+{
+    GPIO_INTR_DISABLE,
+    GPIO_INTR_POSEDGE,
+    GPIO_INTR_NEGEDGE,
+    GPIO_INTR_ANYEDGE,
+    GPIO_INTR_LOW_LEVEL,
+    GPIO_INTR_HIGH_LEVEL,
+} gpio_int_type_t;
+
+struct gpio_dev_t
+{
+};
+inline gpio_dev_t GPIO;
+
+inline int gpio_ll_get_level(gpio_dev_t *, gpio_num_t pin) { return digitalRead(pin); }
+inline void gpio_ll_set_level(gpio_dev_t *, gpio_num_t pin, uint32_t level) { digitalWrite(pin, level); }
+inline void gpio_ll_output_enable(gpio_dev_t *, gpio_num_t pin) { pinMode(pin, OUTPUT); }
+inline void gpio_ll_output_disable(gpio_dev_t *, gpio_num_t pin) { pinMode(pin, INPUT); }
+inline void gpio_ll_set_intr_type(gpio_dev_t *, gpio_num_t, gpio_int_type_t) {}
+
+#endif
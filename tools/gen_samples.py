@@ -0,0 +1,115 @@
+#!/usr/bin/env python3
+"""Generate the sample bank of the alarm synthesizer (src/sample_bank.cpp).
+
+The bank holds 8-bit signed wavetables (one period each) and PCM one-shot
+samples. The chime is synthesized (a decaying inharmonic bell); pass
+--chime to replace it with a recording (mono WAV, 8 or 16 bit, resampled
+to the output rate).
+
+    ./tools/gen_samples.py                       # Regenerate src/sample_bank.cpp
+    ./tools/gen_samples.py --chime ring.wav      # Use a recorded chime
+"""
+
+import argparse
+import math
+import os
+import wave
+
+SAMPLE_RATE = 16000  # AUDIO_SAMPLE_RATE in src/audio_synth.h
+WAVE_LENGTH = 256
+CHIME_LENGTH = 4096
+CHIME_ROOT_HZ = 1046.5  # C6
+
+HEADER = """/// @file sample_bank.cpp
+/// Sample bank of the alarm synthesizer.
+///
+/// Generated by `tools/gen_samples.py`, don't edit the tables by hand.
+/// The tables are `const`, so they stay in flash and are read in place.
+#include "sample_bank.h"
+"""
+
+
+def clip8(x):
+    return max(-127, min(127, int(round(x))))
+
+
+def sine():
+    return [clip8(127 * math.sin(2 * math.pi * i / WAVE_LENGTH)) for i in range(WAVE_LENGTH)]
+
+
+def organ():
+    partials = [(1, 1.0), (2, 0.5), (3, 0.3), (4, 0.15), (6, 0.08)]
+    raw = [sum(a * math.sin(2 * math.pi * h * i / WAVE_LENGTH) for h, a in partials) for i in range(WAVE_LENGTH)]
+    peak = max(abs(x) for x in raw)
+    return [clip8(127 * x / peak) for x in raw]
+
+
+def chime():
+    partials = [(1.0, 1.0, 3.0), (2.76, 0.5, 6.0), (5.40, 0.25, 10.0), (8.93, 0.12, 16.0)]  # Ratio, amplitude, decay
+    raw = []
+    for i in range(CHIME_LENGTH):
+        t = i / SAMPLE_RATE
+        attack = min(1.0, i / 32)
+        raw.append(attack * sum(a * math.exp(-d * t) * math.sin(2 * math.pi * CHIME_ROOT_HZ * r * t) for r, a, d in partials))
+    peak = max(abs(x) for x in raw)
+    return [clip8(127 * x / peak) for x in raw]
+
+
+def load_wav(path):
+    with wave.open(path) as w:
+        if w.getnchannels() != 1 or w.getsampwidth() not in (1, 2):
+            raise SystemExit("%s: mono 8 or 16 bit WAV expected" % path)
+        width, rate = w.getsampwidth(), w.getframerate()
+        frames = w.readframes(w.getnframes())
+    if width == 1:
+        data = [b - 128 for b in frames]
+    else:
+        data = [int.from_bytes(frames[i:i + 2], "little", signed=True) >> 8 for i in range(0, len(frames), 2)]
+    out = []
+    for i in range(min(CHIME_LENGTH * 4, int(len(data) * SAMPLE_RATE / rate))):  # Linear resampling
+        x = i * rate / SAMPLE_RATE
+        j = int(x)
+        b = data[min(j + 1, len(data) - 1)]
+        out.append(clip8(data[j] + (b - data[j]) * (x - j)))
+    return out
+
+
+def table(name, data):
+    lines = ["static const int8_t %s[%d] = {" % (name, len(data))]
+    for i in range(0, len(data), 16):
+        lines.append("    " + ", ".join("%d" % x for x in data[i:i + 16]) + ",")
+    lines.append("};")
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("--chime", help="mono WAV file to use as the chime sample")
+    parser.add_argument("--chime-root-hz", type=float, default=CHIME_ROOT_HZ, help="pitch of the recorded chime")
+    parser.add_argument("-o", "--output", default=os.path.join(os.path.dirname(__file__), "..", "src", "sample_bank.cpp"))
+    args = parser.parse_args()
+
+    chime_data = load_wav(args.chime) if args.chime else chime()
+    chime_root = args.chime_root_hz if args.chime else CHIME_ROOT_HZ
+    wave_root = SAMPLE_RATE / WAVE_LENGTH
+
+    with open(args.output, "w") as f:
+        f.write(HEADER + "\n")
+        f.write(table("WAVE_SINE", sine()) + "\n\n")
+        f.write(table("WAVE_ORGAN", organ()) + "\n\n")
+        f.write(table("PCM_CHIME", chime_data) + "\n\n")
+        f.write("/// @brief The sample bank, indexed by `SampleId`.\n")
+        f.write("const Sample SAMPLES[] = {\n")
+        entries = [
+            ("{WAVE_SINE, %d, 0, %.1ff}," % (WAVE_LENGTH, wave_root), "SAMPLE_SINE: looped wavetable"),
+            ("{WAVE_ORGAN, %d, 0, %.1ff}," % (WAVE_LENGTH, wave_root), "SAMPLE_ORGAN: looped wavetable"),
+            ("{PCM_CHIME, %d, %d, %.1ff}," % (len(chime_data), len(chime_data), chime_root), "SAMPLE_CHIME: one-shot PCM"),
+        ]
+        width = max(len(code) for code, _ in entries)
+        for code, comment in entries:
+            f.write("    %s // %s\n" % (code.ljust(width), comment))
+        f.write("};\n")
+
+
+if __name__ == "__main__":
+    main()
@@ -0,0 +1,386 @@
+#!/usr/bin/env python3
+"""IRAM placement check of the ISR-reachable code.
+
+An interrupt registered IRAM-safe (ESP_INTR_FLAG_IRAM) runs while the flash
+cache is disabled (during a flash write), so everything it executes or reads
+must be in internal RAM: functions with IRAM_ATTR, constants with DRAM_ATTR.
+The ISRs of the clock are kept that way. This check finds the code and data
+an ISR can reach and fails the build if any of it was linked into flash.
+
+Reachability is computed on the project object files: starting from the ISRs
+(ISR_ROOTS), it follows the relocations of each section to the sections they
+point at (called functions, literal pools, tables). The placement of each
+reached section is read from the linker map. Framework functions called from
+an ISR can't be annotated here: the ISRs must not call those that are in flash
+(digitalWrite, tone, timerAlarmWrite... unless the framework is built with
+CONFIG_ARDUINO_ISR_IRAM). They are errors too, or only warnings with --lenient.
+
+It also reports the IRAM bytes used by each module.
+
+PlatformIO runs it after linking (`extra_scripts = post:tools/iram_check.py`
+in platformio.ini). With arduino-cli, run it on the build directory:
+
+    ./iram_check.py --elf cli-build/src.ino.elf --map cli-build/src.ino.map cli-build/sketch/*.o
+
+Uses the Python standard library only.
+"""
+
+import argparse
+import os
+import re
+import shutil
+import struct
+import subprocess
+import sys
+
+# Interrupt service routines: timer interrupt (clock.cpp) and GPIO interrupts (sketch.ino).
+# ISRs missing from a build (e.g. the button ISRs with CLOCK_KEY_SCAN) are skipped.
+ISR_ROOTS = [
+    "onTimer",
+    "buttonMenuInterrupt",
+    "buttonOkInterrupt",
+    "buttonPlusInterrupt",
+    "buttonMinusInterrupt",
+    "switchAlarmInterrupt",
+]
+
+# ESP32 address ranges, from the technical reference manual (address space, embedded memory).
+IRAM = (0x40070000, 0x400C2000)  # Internal SRAM 0/1 instruction bus, and RTC fast memory
+CACHED = [
+    (0x3F400000, 0x3F800000, "flash data"),
+    (0x3F800000, 0x3FC00000, "external RAM"),
+    (0x400C2000, 0x40C00000, "flash code"),
+]
+
+SHT_SYMTAB, SHT_RELA, SHT_REL = 2, 4, 9
+SHN_UNDEF, SHN_LORESERVE = 0, 0xFF00
+STT_OBJECT, STT_FUNC, STT_SECTION = 1, 2, 3
+
+
+class Elf:
+    """Sections, symbols and relocations of a 32-bit little-endian ELF file."""
+
+    def __init__(self, path):
+        self.path = path
+        with open(path, "rb") as f:
+            data = f.read()
+        if data[:4] != b"\x7fELF" or data[4] != 1 or data[5] != 1:
+            raise ValueError("%s: not a 32-bit little-endian ELF file" % path)
+        shoff, = struct.unpack_from("<I", data, 0x20)
+        shentsize, shnum, shstrndx = struct.unpack_from("<HHH", data, 0x2E)
+        headers = [struct.unpack_from("<10I", data, shoff + i * shentsize) for i in range(shnum)]
+        strtab = headers[shstrndx][4] if shnum else 0
+
+        def string(offset):
+            return data[offset:data.index(b"\0", offset)].decode("utf-8", "replace")
+
+        # Per section: [name, type, address, size, link, info]
+        self.sections = [[string(strtab + h[0]), h[1], h[3], h[5], h[6], h[7]] for h in headers]
+
+        # Symbols: (name, value, size, type, bind, section index)
+        self.symbols = []
+        for h in headers:
+            if h[1] == SHT_SYMTAB:
+                names = headers[h[6]][4]
+                for offset in range(h[4], h[4] + h[5], 16):
+                    name, value, size, info, _, shndx = struct.unpack_from("<IIIBBH", data, offset)
+                    self.symbols.append((string(names + name), value, size, info & 0xF, info >> 4, shndx))
+                break
+
+        # Relocations by target section: symbol indexes
+        self.relocations = {}
+        for h in headers:
+            if h[1] in (SHT_RELA, SHT_REL):
+                entsize = 12 if h[1] == SHT_RELA else 8
+                targets = self.relocations.setdefault(h[7], set())
+                for offset in range(h[4], h[4] + h[5], entsize):
+                    info, = struct.unpack_from("<I", data, offset + 4)
+                    targets.add(info >> 8)
+
+
+def mangled_name(name):
+    """The identifier of a simple mangled function name (`_Z7onTimerv` -> `onTimer`)."""
+    m = re.match(r"_Z(\d+)", name)
+    if not m:
+        return name
+    start = m.end()
+    return name[start:start + int(m.group(1))]
+
+
+def module_name(path):
+    """Module of an input file of the map: the object, or the archive of an archive member."""
+    m = re.match(r"(.*\.a)\(.*\)$", path)
+    name = os.path.basename(m.group(1) if m else path)
+    return name[:-2] if name.endswith(".o") else name
+
+
+def parse_map(path):
+    """Input sections of a GNU ld map file.
+
+    @return (placed, discarded, iram_length): placed maps (file, section) to its
+            address and size, discarded is the set of (file, section) removed by the
+            linker, and iram_length is the length of the IRAM segment if listed.
+    """
+    with open(path, encoding="utf-8", errors="replace") as f:
+        lines = f.read().splitlines()
+    placed, discarded, iram_length = {}, set(), None
+    part = None
+    entry = re.compile(r"^ (\S+)\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+    wrapped = re.compile(r"^\s+0x([0-9a-fA-F]+)\s+0x([0-9a-fA-F]+)\s+(\S.*)$")
+    pending = None  # Section name alone on its line, when it is too long to share it with the address
+    for line in lines:
+        if line.startswith("Discarded input sections"):
+            part = "discarded"
+        elif line.startswith("Memory Configuration"):
+            part = "memory"
+        elif line.startswith("Linker script and memory map"):
+            part = "map"
+        if part == "memory":
+            m = re.match(r"^iram0_0_seg\s+0x[0-9a-fA-F]+\s+0x([0-9a-fA-F]+)", line)
+            if m:
+                iram_length = int(m.group(1), 16)
+            continue
+        if part not in ("map", "discarded"):
+            continue
+
+        m = entry.match(line)
+        if m:
+            name, address, size, file = m.group(1), int(m.group(2), 16), int(m.group(3), 16), m.group(4).strip()
+        elif pending and wrapped.match(line):
+            m = wrapped.match(line)
+            name, address, size, file = pending, int(m.group(1), 16), int(m.group(2), 16), m.group(3).strip()
+        else:
+            pending = line[1:] if re.match(r"^ [^\s*]\S*$", line) else None
+            continue
+        pending = None
+        if name.startswith("*") or file.startswith("0x"):
+            continue
+        if part == "discarded":
+            discarded.add((file, name))
+        else:
+            placed[(file, name)] = (address, size)
+    return placed, discarded, iram_length
+
+
+def region(address):
+    """Name of the cached (flash or external RAM) region of an address, or None for internal memory and ROM."""
+    for start, end, name in CACHED:
+        if start <= address < end:
+            return name
+    return None
+
+
+class Demangler:
+    """Demangles names with c++filt when available. Leaves them as they are otherwise."""
+
+    def __init__(self, tool):
+        self.tool = tool
+        self.cache = {}
+
+    def __call__(self, name):
+        if name not in self.cache:
+            self.cache[name] = name
+            if self.tool and name.startswith("_Z"):
+                try:
+                    out = subprocess.run([self.tool, name], capture_output=True, text=True, check=True).stdout
+                    self.cache[name] = out.strip() or name
+                except (OSError, subprocess.CalledProcessError):
+                    self.tool = None
+        return self.cache[name]
+
+
+def check(elf_path, map_path, object_paths, strict=True, demangle=None, out=sys.stdout):
+    """Run the check and print the report.
+
+    @return The number of errors: ISR-reachable project sections in flash, plus
+            framework functions in flash unless `strict` is false.
+    """
+    demangle = demangle or Demangler(None)
+    objects = [Elf(p) for p in object_paths]
+    image = Elf(elf_path)
+    placed, discarded, iram_length = parse_map(map_path)
+
+    # Map file names to objects, by path or else by file name
+    by_path = {os.path.realpath(o.path): o for o in objects}
+    by_base = {}
+    for o in objects:
+        by_base.setdefault(os.path.basename(o.path), []).append(o)
+
+    def object_of(file):
+        o = by_path.get(os.path.realpath(file))
+        if o is None:
+            candidates = by_base.get(os.path.basename(file), [])
+            o = candidates[0] if len(candidates) == 1 else None
+        return o
+
+    placement = {}  # (object, section index) -> address
+    dropped = set()
+    names = {}
+    for o in objects:
+        index = {s[0]: i for i, s in enumerate(o.sections)}
+        names[o.path] = index
+    for (file, section), (address, _) in placed.items():
+        o = object_of(file)
+        if o is not None and section in names[o.path]:
+            placement[(o.path, names[o.path][section])] = address
+    for file, section in discarded:
+        o = object_of(file)
+        if o is not None and section in names[o.path]:
+            dropped.add((o.path, names[o.path][section]))
+
+    # Definitions of the global symbols, and addresses in the linked image
+    definitions = {}
+    for o in objects:
+        for name, _, _, kind, bind, shndx in o.symbols:
+            if bind != 0 and SHN_UNDEF < shndx < SHN_LORESERVE and kind in (STT_FUNC, STT_OBJECT):
+                definitions.setdefault(name, (o, shndx))
+    linked = {}
+    for name, value, _, kind, bind, shndx in image.symbols:
+        if bind != 0 and kind in (STT_FUNC, STT_OBJECT) and shndx != SHN_UNDEF:
+            linked[name] = value
+
+    def label(o, shndx):
+        best = None
+        for name, value, _, kind, _, index in o.symbols:
+            if index == shndx and kind in (STT_FUNC, STT_OBJECT) and (best is None or value < best[1]):
+                best = (name, value)
+        if best:
+            return demangle(best[0])
+        return "%s(%s)" % (os.path.basename(o.path), o.sections[shndx][0])
+
+    def address_of(o, shndx):
+        """Address of a section in the image, through the map, or the symbols of a discarded COMDAT copy."""
+        if (o.path, shndx) in placement:
+            return placement[(o.path, shndx)]
+        for name, value, _, kind, bind, index in o.symbols:
+            if index == shndx and bind != 0 and name in linked:
+                return linked[name] - value
+        return None
+
+    # Breadth-first search from the ISRs, over the sections of the project objects
+    parent = {}
+    queue = []
+    externals = {}
+    found_roots = []
+    for root in ISR_ROOTS:
+        for o in objects:
+            for name, _, _, kind, _, shndx in o.symbols:
+                if kind == STT_FUNC and SHN_UNDEF < shndx < SHN_LORESERVE and mangled_name(name) == root:
+                    node = (o, shndx)
+                    if (o.path, shndx) not in parent and (o.path, shndx) not in dropped:
+                        parent[(o.path, shndx)] = None
+                        queue.append(node)
+                        found_roots.append(root)
+    while queue:
+        o, shndx = queue.pop(0)
+        for sym in o.relocations.get(shndx, ()):
+            name, _, _, kind, _, index = o.symbols[sym]
+            if index == SHN_UNDEF:
+                target = definitions.get(name)
+                if target is None:
+                    externals.setdefault(name, (o, shndx))
+                    continue
+            elif index >= SHN_LORESERVE:
+                continue  # Absolute or common symbol: no section to follow
+            else:
+                target = (o, index)
+            key = (target[0].path, target[1])
+            if key not in parent:
+                parent[key] = (o, shndx)
+                queue.append(target)
+
+    def path_to(o, shndx):
+        chain = []
+        node = (o, shndx)
+        while node is not None:
+            if node[0].sections[node[1]][0].find("literal") < 0:
+                chain.append(label(*node))
+            node = parent[(node[0].path, node[1])]
+        return " -> ".join(reversed(chain))
+
+    errors = 0
+    by_object = {o.path: o for o in objects}
+    print("ISRs: %s" % (", ".join(found_roots) or "none found"), file=out)
+    for path, shndx in parent:
+        o = by_object[path]
+        section = o.sections[shndx]
+        if section[3] == 0:
+            continue
+        address = address_of(o, shndx)
+        if address is None:
+            if (path, shndx) not in dropped:
+                print("warning: %s is not in the map" % label(o, shndx), file=out)
+            continue
+        where = region(address)
+        if where:
+            errors += 1
+            print("error: %s (%s) is in %s at 0x%08x, reached by %s"
+                  % (label(o, shndx), section[0], where, address, path_to(o, shndx)), file=out)
+
+    for name in sorted(externals):
+        address = linked.get(name)
+        where = region(address) if address is not None else None
+        if where:
+            errors += strict
+            print("%s: %s is in %s at 0x%08x, reached by %s"
+                  % ("error" if strict else "warning", demangle(name), where, address,
+                     path_to(*externals[name])), file=out)
+
+    # IRAM bytes by module
+    usage = {}
+    for (file, _), (address, size) in placed.items():
+        if IRAM[0] <= address < IRAM[1] and size:
+            module = module_name(file)
+            usage[module] = usage.get(module, 0) + size
+    project = {module_name(o.path) for o in objects}
+    print("IRAM by module:", file=out)
+    for module in sorted(usage, key=lambda m: (m not in project, -usage[m])):
+        print("  %-32s %7d" % (module + (" *" if module in project else ""), usage[module]), file=out)
+    total = sum(usage.values())
+    print("  %-32s %7d%s" % ("total", total, " of %d" % iram_length if iram_length else ""), file=out)
+    print("IRAM check: %d error(s)" % errors, file=out)
+    return errors
+
+
+def find_demangler(env=None):
+    """The c++filt of the toolchain (next to the compiler), or of the host."""
+    path = None
+    tool = "c++filt"
+    if env is not None:
+        compiler = env.subst("$CXX")
+        if compiler.endswith("g++"):
+            tool = compiler[:-3] + "c++filt"
+        path = env["ENV"].get("PATH")
+    return Demangler(shutil.which(tool, path=path) or shutil.which("c++filt"))
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("objects", nargs="+", help="object files of the project sources")
+    parser.add_argument("--elf", required=True, help="linked firmware")
+    parser.add_argument("--map", required=True, help="linker map of the firmware")
+    parser.add_argument("--lenient", action="store_true", help="only warn on framework functions in flash")
+    args = parser.parse_args()
+    return 1 if check(args.elf, args.map, args.objects, not args.lenient, find_demangler()) else 0
+
+
+try:
+    Import("env", "projenv")  # noqa: F821 - Defined when PlatformIO runs the script
+except NameError:
+    env = None
+
+if env is not None:
+    # Switch jump tables and switch conversion tables are emitted in flash rodata, even in IRAM functions
+    projenv.Append(CCFLAGS=["-fno-jump-tables", "-fno-tree-switch-conversion"])  # noqa: F821
+    env.Append(LINKFLAGS=["-Wl,-Map,$BUILD_DIR/${PROGNAME}.map"])
+
+    def iram_check(target, source, env):
+        objects = []
+        for root, _, files in os.walk(env.subst("$BUILD_DIR/src")):
+            objects += [os.path.join(root, f) for f in files if f.endswith(".o")]
+        return 1 if check(str(target[0]), env.subst("$BUILD_DIR/${PROGNAME}.map"), sorted(objects),
+                          "--lenient" not in env.GetProjectOption("custom_iram_check", ""), find_demangler(env)) else 0
+
+    env.AddPostAction("$BUILD_DIR/${PROGNAME}.elf", iram_check)
+elif __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,286 @@
+#!/usr/bin/env python3
+"""Build and validate configuration bundles of the alarm clock.
+
+A bundle (src/config_bundle.h) holds the preset alarms, the alarm melodies
+and the menu labels, encoded for the 7-segment display. It is written to
+the `config` data partition (src/partitions.csv) and read in place by the
+firmware, which only checks its header and checksum: this tool checks
+everything else when the bundle is built.
+
+    ./tools/mkbundle.py build tools/bundle.json -o bundle.bin   # Build a bundle
+    ./tools/mkbundle.py check bundle.bin                        # Validate a bundle and list its contents
+    ./tools/mkbundle.py cpp tools/bundle.json                   # Regenerate the built-in bundle (src/default_bundle.cpp)
+
+The source is a JSON file, see tools/bundle.json. Write the bundle with the
+offset printed by `build`, e.g. `esptool.py write_flash 0x290000 bundle.bin`.
+
+Uses the Python standard library only.
+"""
+
+import argparse
+import json
+import os
+import re
+import struct
+import sys
+import zlib
+
+SRC = os.path.normpath(os.path.join(os.path.dirname(os.path.abspath(__file__)), "..", "src"))
+
+# Must match src/config_bundle.h
+MAGIC = 0x47464341
+VERSION_MAJOR = 1
+VERSION_MINOR = 0
+RESIDENT_MAX = 512
+LABEL_DIGITS = 8
+PARTITION_SUBTYPE = 0x40
+HEADER = struct.Struct("<IBBHIIIHH")
+SECTION = struct.Struct("<IHH")
+ALARM = struct.Struct("<BBBB")  # BundleAlarm: hour, minute, days, flags
+TONE = struct.Struct("<HH")     # BundleTone: hz, ms
+NOTE = struct.Struct("<BBH")    # Note of src/audio_synth.h: key, sample, ms
+SECTIONS = ["alarms", "tones", "labels", "melody"]  # BundleSectionId
+RESIDENT = {"alarms", "tones", "labels"}
+RECORD_SIZES = {"alarms": ALARM.size, "tones": TONE.size, "labels": LABEL_DIGITS, "melody": NOTE.size}
+LABELS = ["set", "alarm", "stopwatch", "countdown", "off"]  # LabelId
+ALARM_ENABLED = 0x01
+WEEKDAYS = ["sun", "mon", "tue", "wed", "thu", "fri", "sat"]
+
+# 7-segment font of char2segments() in src/tm1637.cpp, and the digits of its tube_tab
+FONT = {
+    "_": 0x08, "^": 0x01, "-": 0x40, "*": 0x63, " ": 0x00,
+    "A": 0x77, "a": 0x5f, "B": 0x7c, "b": 0x7c, "C": 0x39, "c": 0x58, "D": 0x5e, "d": 0x5e,
+    "E": 0x79, "e": 0x79, "F": 0x71, "f": 0x71, "G": 0x35, "g": 0x35, "H": 0x76, "h": 0x74,
+    "I": 0x06, "i": 0x04, "J": 0x1e, "j": 0x16, "K": 0x75, "k": 0x75, "L": 0x38, "l": 0x38,
+    "M": 0x37, "m": 0x37, "N": 0x54, "n": 0x54, "O": 0x5c, "o": 0x5c, "P": 0x73, "p": 0x73,
+    "Q": 0x7b, "q": 0x67, "R": 0x50, "r": 0x50, "S": 0x6d, "s": 0x6d, "T": 0x78, "t": 0x78,
+    "U": 0x1c, "u": 0x1c, "V": 0x3e, "v": 0x3e, "W": 0x7e, "w": 0x2a, "X": 0x76, "x": 0x76,
+    "Y": 0x6e, "y": 0x6e, "Z": 0x1b, "z": 0x1b,
+}
+FONT.update(zip("0123456789", [0x3f, 0x06, 0x5b, 0x4f, 0x66, 0x6d, 0x7d, 0x07, 0x7f, 0x6f]))
+NOTE_NAMES = {"C": 0, "D": 2, "E": 4, "F": 5, "G": 7, "A": 9, "B": 11}
+
+
+class BundleError(Exception):
+    pass
+
+
+def sample_ids():
+    """Sample names and indexes, from the SampleId enum of src/sample_bank.h."""
+    with open(os.path.join(SRC, "sample_bank.h")) as f:
+        return {m.group(1).lower(): int(m.group(2)) for m in re.finditer(r"SAMPLE_(\w+)\s*=\s*(\d+)", f.read())}
+
+
+def partition(path):
+    """Offset and size of the config partition in a partitions.csv file, or None."""
+    with open(path) as f:
+        for line in f:
+            fields = [x.strip() for x in line.split("#")[0].split(",")]
+            if len(fields) >= 5 and fields[0] == "config":
+                if fields[1] != "data" or int(fields[2], 0) != PARTITION_SUBTYPE:
+                    raise BundleError("%s: the config partition must be data, subtype 0x%x" % (path, PARTITION_SUBTYPE))
+                return int(fields[3], 0), int(fields[4], 0)
+    return None
+
+
+def midi_key(key):
+    """MIDI key of a note name (`C5`, `F#4`) or number."""
+    if isinstance(key, int):
+        return key
+    m = re.fullmatch(r"([A-G])(#|b)?(-?\d)", str(key))
+    if not m:
+        raise BundleError("bad note %r" % key)
+    return NOTE_NAMES[m.group(1)] + {"#": 1, "b": -1, None: 0}[m.group(2)] + 12 * (int(m.group(3)) + 1)
+
+
+def encode_label(text):
+    """7-segment encoding of a label, padded with blank digits."""
+    if len(text) > LABEL_DIGITS:
+        raise BundleError("label %r is longer than %d digits" % (text, LABEL_DIGITS))
+    missing = [c for c in text if c not in FONT]
+    if missing:
+        raise BundleError("label %r: no 7-segment encoding for %r" % (text, "".join(missing)))
+    return bytes(FONT[c] for c in text).ljust(LABEL_DIGITS, b"\0")
+
+
+def records(config):
+    """The records of each section, encoded, from a parsed JSON source."""
+    samples = sample_ids()
+    alarms = b""
+    for alarm in config.get("alarms", []):
+        m = re.fullmatch(r"(\d{1,2}):(\d{2})", alarm["time"])
+        if not m or int(m.group(1)) > 23 or int(m.group(2)) > 59:
+            raise BundleError("bad alarm time %r" % alarm["time"])
+        days = alarm.get("days", WEEKDAYS)
+        unknown = [d for d in days if d not in WEEKDAYS]
+        if unknown or not days:
+            raise BundleError("bad alarm days %r" % days)
+        mask = sum(1 << WEEKDAYS.index(d) for d in set(days))
+        flags = ALARM_ENABLED if alarm.get("enabled", True) else 0
+        alarms += ALARM.pack(int(m.group(1)), int(m.group(2)), mask, flags)
+
+    tones = b""
+    for tone in config["tones"]:
+        if not 0 <= tone["hz"] <= 20000 or not 0 < tone["ms"] < 65536:
+            raise BundleError("bad tone %r" % tone)
+        tones += TONE.pack(tone["hz"], tone["ms"])
+
+    melody = b""
+    for note in config["melody"]:
+        if "rest" in note:
+            key, sample, ms = 0, 0, note["rest"]
+        else:
+            key, ms = midi_key(note["key"]), note["ms"]
+            if note["sample"] not in samples:
+                raise BundleError("unknown sample %r (known: %s)" % (note["sample"], ", ".join(samples)))
+            sample = samples[note["sample"]]
+            if not 0 < key < 128:
+                raise BundleError("note %r out of range" % note["key"])
+        if not 0 < ms < 65536:
+            raise BundleError("bad note duration %r" % ms)
+        melody += NOTE.pack(key, sample, ms)
+
+    unknown = set(config["labels"]) - set(LABELS)
+    if unknown:
+        raise BundleError("unknown labels %s (known: %s)" % (", ".join(sorted(unknown)), ", ".join(LABELS)))
+    labels = b"".join(encode_label(config["labels"][name]) for name in LABELS)
+
+    return {"alarms": alarms, "tones": tones, "labels": labels, "melody": melody}
+
+
+def build(config):
+    """Encode a bundle: header, section table, resident sections, mapped sections."""
+    data = records(config)
+    header_size = HEADER.size + len(SECTIONS) * SECTION.size
+    body = b""
+    table = []
+    for name in sorted(SECTIONS, key=lambda n: n not in RESIDENT):  # Resident sections first
+        body += b"\0" * (-len(body) % 4)
+        table.append((name, header_size + len(body)))
+        body += data[name]
+        if name in RESIDENT:
+            resident_size = len(body)
+    body += b"\0" * (-len(body) % 4)
+    offsets = dict(table)
+    sections = b"".join(SECTION.pack(offsets[n], len(data[n]) // RECORD_SIZES[n], RECORD_SIZES[n]) for n in SECTIONS)
+    if resident_size > RESIDENT_MAX:
+        raise BundleError("resident sections take %d bytes, more than %d" % (resident_size, RESIDENT_MAX))
+
+    size = header_size + len(body)
+    bundle = HEADER.pack(MAGIC, VERSION_MAJOR, VERSION_MINOR, header_size, size, 0, resident_size, len(SECTIONS), 0) + sections + body
+    crc = zlib.crc32(bundle[16:])  # The bytes after the crc32 field
+    return bundle[:12] + struct.pack("<I", crc) + bundle[16:]
+
+
+def check(bundle, capacity=None):
+    """Validate a bundle like the firmware does, then the records. Returns the decoded contents."""
+    if len(bundle) < HEADER.size:
+        raise BundleError("too short for a header")
+    magic, major, minor, header_size, size, crc, resident_size, count, _ = HEADER.unpack_from(bundle)
+    if magic != MAGIC:
+        raise BundleError("bad magic 0x%08x" % magic)
+    if major != VERSION_MAJOR:
+        raise BundleError("version %d.%d, the firmware reads %d.x" % (major, minor, VERSION_MAJOR))
+    if size > len(bundle) or (capacity is not None and size > capacity):
+        raise BundleError("size %d is larger than the %d bytes available" % (size, min(len(bundle), capacity or len(bundle))))
+    if count < len(SECTIONS) or header_size < HEADER.size + count * SECTION.size or header_size % 4:
+        raise BundleError("bad section table (%d sections, header size %d)" % (count, header_size))
+    if resident_size > RESIDENT_MAX or header_size + resident_size > size:
+        raise BundleError("bad resident size %d" % resident_size)
+    if zlib.crc32(bundle[16:size]) != crc:
+        raise BundleError("bad checksum")
+
+    contents = {"version": "%d.%d" % (major, minor), "size": size, "resident": resident_size}
+    samples = {v: k for k, v in sample_ids().items()}
+    for i, name in enumerate(SECTIONS):
+        offset, n, record_size = SECTION.unpack_from(bundle, HEADER.size + i * SECTION.size)
+        end = offset + n * record_size
+        limit = header_size + resident_size if name in RESIDENT else size
+        if record_size != RECORD_SIZES[name] or offset % 4 or offset < header_size or end > limit:
+            raise BundleError("bad %s section (offset %d, %d records of %d bytes)" % (name, offset, n, record_size))
+        raw = [bundle[offset + j * record_size:offset + (j + 1) * record_size] for j in range(n)]
+        if name == "alarms":
+            items = [ALARM.unpack(r) for r in raw]
+            for hour, minute, days, flags in items:
+                if hour > 23 or minute > 59 or days > 0x7f:
+                    raise BundleError("bad alarm %02d:%02d days 0x%02x" % (hour, minute, days))
+            contents[name] = ["%02d:%02d %s%s" % (h, m, ",".join(d for b, d in enumerate(WEEKDAYS) if days >> b & 1),
+                                                   "" if f & ALARM_ENABLED else " (disabled)") for h, m, days, f in items]
+        elif name == "tones":
+            if not raw:
+                raise BundleError("no tones")
+            contents[name] = ["%d Hz %d ms" % TONE.unpack(r) for r in raw]
+        elif name == "labels":
+            if n < len(LABELS):
+                raise BundleError("%d labels, %d needed" % (n, len(LABELS)))
+            glyphs = {v: k for k, v in reversed(list(FONT.items()))}
+            contents[name] = ["%s: %s" % (LABELS[j], "".join(glyphs.get(b, "?") for b in r).rstrip() or "(blank)")
+                              for j, r in enumerate(raw[:len(LABELS)])]
+        else:
+            if not raw:
+                raise BundleError("empty melody")
+            notes = []
+            for key, sample, ms in (NOTE.unpack(r) for r in raw):
+                if key and sample not in samples:
+                    raise BundleError("melody uses sample %d, the bank has %d" % (sample, len(samples)))
+                notes.append("rest %d ms" % ms if not key else "%d %s %d ms" % (key, samples[sample], ms))
+            contents[name] = notes
+    return contents
+
+
+def cpp(bundle, source):
+    lines = ["/// @file default_bundle.cpp",
+             "/// Configuration bundle built into the firmware, used when the `config` partition has no valid bundle.",
+             "///",
+             "/// Generated by `tools/mkbundle.py cpp %s`, don't edit by hand." % source,
+             '#include "config_bundle.h"',
+             "",
+             "alignas(4) const uint8_t DEFAULT_BUNDLE[] = {"]
+    for i in range(0, len(bundle), 16):
+        lines.append("    " + " ".join("0x%02x," % b for b in bundle[i:i + 16]))
+    lines += ["};", "const uint32_t DEFAULT_BUNDLE_SIZE = sizeof(DEFAULT_BUNDLE);", ""]
+    return "\n".join(lines)
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("command", choices=["build", "check", "cpp"])
+    parser.add_argument("input", help="JSON source (build, cpp) or bundle (check)")
+    parser.add_argument("-o", "--output", help="output file (default: bundle.bin, or src/default_bundle.cpp)")
+    parser.add_argument("--partitions", default=os.path.join(SRC, "partitions.csv"), help="partition table with the config partition")
+    args = parser.parse_args()
+
+    try:
+        area = partition(args.partitions) if os.path.exists(args.partitions) else None
+        if args.command == "check":
+            with open(args.input, "rb") as f:
+                contents = check(f.read(), area[1] if area else None)
+            print("%s: valid bundle %s, %d bytes (%d resident)" % (args.input, contents["version"], contents["size"], contents["resident"]))
+            for name in SECTIONS:
+                print("%s:" % name)
+                for item in contents[name]:
+                    print("    " + item)
+            return 0
+
+        with open(args.input) as f:
+            bundle = build(json.load(f))
+        check(bundle, area[1] if area else None)
+        if args.command == "cpp":
+            output = args.output or os.path.join(SRC, "default_bundle.cpp")
+            with open(output, "w") as f:
+                f.write(cpp(bundle, os.path.relpath(args.input, os.path.join(SRC, ".."))))
+        else:
+            output = args.output or "bundle.bin"
+            with open(output, "wb") as f:
+                f.write(bundle)
+        print("%s: %d bytes" % (output, len(bundle)))
+        if area and args.command == "build":
+            print("write it with: esptool.py --chip esp32 write_flash 0x%x %s" % (area[0], output))
+    except (BundleError, KeyError, TypeError, ValueError) as e:
+        print("error: %s" % (e if not isinstance(e, KeyError) else "missing %s" % e), file=sys.stderr)
+        return 1
+    return 0
+
+
+if __name__ == "__main__":
+    sys.exit(main())
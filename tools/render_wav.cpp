@@ -0,0 +1,123 @@
+/// @file render_wav.cpp
+/// Renders the alarm melody to a WAV file on the host, and reports the CPU cost per buffer.
+///
+/// The melody is read from the configuration bundle, like the firmware does: the built-in one
+/// (`default_bundle.cpp`), or a bundle file built by `tools/mkbundle.py`. Build and run from the
+/// repository root:
+///
+///     g++ -O2 -Isrc -Itools/bench/shim tools/render_wav.cpp src/audio_synth.cpp src/sample_bank.cpp
+///         src/config_bundle.cpp src/default_bundle.cpp -o render_wav   # One command line
+///     ./render_wav alarm.wav 8              # Melody of the built-in bundle
+///     ./render_wav alarm.wav 8 bundle.bin   # Melody of a bundle file
+///
+/// The cost is measured on the host, so it is only a relative figure. The firmware prints the
+/// same statistics, measured on the ESP32, every time the alarm stops ringing (`ALARM_AUDIO_PCM`).
+#include <chrono>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <vector>
+#include "audio_synth.h"
+#include "config_bundle.h"
+#include "sample_bank.h"
+
+/// @brief Write a little-endian integer of `bytes` bytes.
+static void put(FILE *file, uint32_t value, int bytes)
+{
+    for (int i = 0; i < bytes; i++)
+    {
+        fputc(value >> (8 * i) & 0xFF, file);
+    }
+}
+
+/// @brief Write a 16-bit mono PCM WAV file.
+static bool write_wav(const char *path, const std::vector<int16_t> &samples)
+{
+    FILE *file = fopen(path, "wb");
+    if (!file)
+    {
+        return false;
+    }
+    uint32_t data_bytes = samples.size() * 2;
+    fputs("RIFF", file);
+    put(file, 36 + data_bytes, 4);
+    fputs("WAVEfmt ", file);
+    put(file, 16, 4);                     // fmt chunk size
+    put(file, 1, 2);                      // PCM
+    put(file, 1, 2);                      // Mono
+    put(file, AUDIO_SAMPLE_RATE, 4);
+    put(file, AUDIO_SAMPLE_RATE * 2, 4);  // Bytes per second
+    put(file, 2, 2);                      // Bytes per frame
+    put(file, 16, 2);                     // Bits per sample
+    fputs("data", file);
+    put(file, data_bytes, 4);
+    for (int16_t sample : samples)
+    {
+        put(file, (uint16_t)sample, 2);
+    }
+    return fclose(file) == 0;
+}
+
+/// @brief Read a bundle file, and use it instead of the built-in bundle.
+/// @param storage Holds the bundle, which is read in place. 4-byte aligned, as in flash.
+static bool attach_bundle(const char *path, std::vector<uint32_t> &storage)
+{
+    FILE *file = fopen(path, "rb");
+    if (!file)
+    {
+        perror(path);
+        return false;
+    }
+    std::vector<uint8_t> bytes;
+    int c;
+    while ((c = fgetc(file)) != EOF)
+    {
+        bytes.push_back(c);
+    }
+    fclose(file);
+    storage.assign((bytes.size() + 3) / 4, 0);
+    memcpy(storage.data(), bytes.data(), bytes.size());
+    if (!config_bundle.attach((const uint8_t *)storage.data(), bytes.size()))
+    {
+        fprintf(stderr, "%s: not a valid bundle\n", path);
+        return false;
+    }
+    return true;
+}
+
+int main(int argc, char *argv[])
+{
+    const char *path = argc > 1 ? argv[1] : "alarm.wav";
+    double seconds = argc > 2 ? atof(argv[2]) : 8.0;
+    size_t buffers = seconds * AUDIO_SAMPLE_RATE / AUDIO_BUFFER_SAMPLES;
+
+    std::vector<uint32_t> bundle;
+    if (argc > 3 && !attach_bundle(argv[3], bundle))
+    {
+        return 1;
+    }
+    AudioSynth synth;
+    synth.start(SAMPLES, config_bundle.melody(), config_bundle.melody_length());
+
+    std::vector<int16_t> samples(buffers * AUDIO_BUFFER_SAMPLES);
+    double total_ns = 0, max_ns = 0;
+    for (size_t i = 0; i < buffers; i++)
+    {
+        auto start = std::chrono::steady_clock::now();
+        synth.render(&samples[i * AUDIO_BUFFER_SAMPLES], AUDIO_BUFFER_SAMPLES);
+        double ns = std::chrono::duration<double, std::nano>(std::chrono::steady_clock::now() - start).count();
+        total_ns += ns;
+        max_ns = ns > max_ns ? ns : max_ns;
+    }
+
+    if (!write_wav(path, samples))
+    {
+        perror(path);
+        return 1;
+    }
+    double budget_ns = 1e9 * AUDIO_BUFFER_SAMPLES / AUDIO_SAMPLE_RATE;
+    printf("%s: %zu buffers of %d samples (%.1f s)\n", path, buffers, AUDIO_BUFFER_SAMPLES, (double)samples.size() / AUDIO_SAMPLE_RATE);
+    printf("render: avg %.0f ns, max %.0f ns per buffer, %.3f%% of the %.0f us buffer period\n",
+           total_ns / buffers, max_ns, 100 * total_ns / buffers / budget_ns, budget_ns / 1000);
+    return 0;
+}
@@ -0,0 +1,180 @@
+#!/usr/bin/env python3
+"""Reference time synchronization daemon for the alarm clock.
+
+Speaks the serial protocol of src/time_sync.h: sends `SYNC <t1>`, reads back
+`SYNC <t1> <t2> <t3>`, and corrects the clock with `ADJ <offset>`. Each round
+takes several samples and keeps the one with the shortest round-trip delay,
+which is the least disturbed by serial and polling latency.
+
+    ./timesync.py /dev/ttyUSB0              # Synchronize a real clock
+    ./timesync.py --simulate --rounds 10    # Run against a simulated clock on a pty
+    ./timesync.py --simulate --sim-boot     # ... that starts at the boot time of the firmware, in 1970
+
+Uses the Python standard library only (POSIX).
+"""
+
+import argparse
+import math
+import os
+import random
+import select
+import statistics
+import sys
+import termios
+import threading
+import time
+
+STEP_US = 1000000  # SYNC_STEP_MS of the firmware: larger corrections are stepped, smaller ones slewed
+BOOT_US = (18 * 3600 + 56 * 60 + 55) * 1000000  # Time set by setup() in sketch.ino: 1970-01-01 18:56:55
+
+
+def now_us():
+    return time.time_ns() // 1000
+
+
+def open_serial(path, baud):
+    """Open a serial port (or pty) in raw mode."""
+    fd = os.open(path, os.O_RDWR | os.O_NOCTTY)
+    attrs = termios.tcgetattr(fd)
+    attrs[0] = 0                                               # iflag
+    attrs[1] = 0                                               # oflag
+    attrs[2] = termios.CS8 | termios.CREAD | termios.CLOCAL    # cflag
+    attrs[3] = 0                                               # lflag
+    speed = getattr(termios, "B%d" % baud)
+    attrs[4] = attrs[5] = speed
+    attrs[6][termios.VMIN] = 0
+    attrs[6][termios.VTIME] = 0
+    termios.tcsetattr(fd, termios.TCSANOW, attrs)
+    termios.tcflush(fd, termios.TCIOFLUSH)
+    return fd
+
+
+class LineReader:
+    def __init__(self, fd):
+        self.fd = fd
+        self.buffer = b""
+
+    def readline(self, timeout):
+        """Return the next line and its receive time (t4), or (None, None) on timeout."""
+        deadline = time.monotonic() + timeout
+        while b"\n" not in self.buffer:
+            left = deadline - time.monotonic()
+            if left <= 0 or not select.select([self.fd], [], [], left)[0]:
+                return None, None
+            self.buffer += os.read(self.fd, 256)
+        t4 = now_us()
+        line, self.buffer = self.buffer.split(b"\n", 1)
+        return line.decode(errors="replace").strip(), t4
+
+
+def sample(fd, reader, timeout):
+    """One exchange. Returns (offset, delay) in microseconds, or None."""
+    t1 = now_us()
+    os.write(fd, b"SYNC %d\n" % t1)
+    while True:
+        line, t4 = reader.readline(timeout)
+        if line is None:
+            return None
+        fields = line.split()
+        if len(fields) == 4 and fields[0] == "SYNC" and int(fields[1]) == t1:  # Skip console output and stale replies
+            t2, t3 = int(fields[2]), int(fields[3])
+            offset = ((t2 - t1) + (t3 - t4)) / 2
+            delay = (t4 - t1) - (t3 - t2)
+            return offset, delay
+
+
+def simulate(fd, initial_offset_us, drift_ppm):
+    """Emulate the firmware on the slave side of a pty: a drifting clock that slews small corrections."""
+    start = time.monotonic_ns() // 1000
+    base = now_us() + initial_offset_us
+    state = {"adjust": 0.0, "slew": 0.0, "mono": 0}
+    rate = 1 + drift_ppm * 1e-6
+
+    def clock_us():
+        mono = time.monotonic_ns() // 1000 - start
+        limit = 2e-3 * (mono - state["mono"])  # Slew at most 2 ms per second, like the firmware (1 ms per 0.5 s tick)
+        applied = max(-limit, min(limit, state["slew"]))
+        state["slew"] -= applied
+        state["adjust"] += applied
+        state["mono"] = mono
+        return int(base + mono * rate + state["adjust"])
+
+    def serve():
+        reader = LineReader(fd)
+        while True:
+            line, _ = reader.readline(3600)
+            if line is None:
+                continue
+            time.sleep(random.uniform(0.0002, 0.002))  # Polling and UART latency
+            t2 = clock_us()
+            fields = line.split()
+            if fields[0] == "SYNC":
+                reply = "SYNC %s %d %d\n" % (fields[1], t2, clock_us())
+            elif fields[0] == "ADJ":
+                offset = int(fields[1])
+                if abs(offset) >= STEP_US:
+                    rest = offset % 1000  # Step whole milliseconds, slew the rest
+                    state["adjust"] += offset - rest
+                    state["slew"] = rest
+                else:
+                    state["slew"] = offset  # Replaces the correction still being slewed
+                reply = "ADJ %d\n" % offset
+            else:
+                continue
+            time.sleep(random.uniform(0.0002, 0.002))
+            os.write(fd, reply.encode())
+
+    threading.Thread(target=serve, daemon=True).start()
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__, formatter_class=argparse.RawDescriptionHelpFormatter)
+    parser.add_argument("port", nargs="?", help="serial port of the clock")
+    parser.add_argument("--baud", type=int, default=115200)
+    parser.add_argument("--samples", type=int, default=8, help="samples per round")
+    parser.add_argument("--interval", type=float, default=2.0, help="seconds between rounds")
+    parser.add_argument("--rounds", type=int, default=0, help="stop after this many rounds (0: run forever)")
+    parser.add_argument("--dry-run", action="store_true", help="measure only, don't send ADJ")
+    parser.add_argument("--simulate", action="store_true", help="run against a simulated clock on a pty")
+    parser.add_argument("--sim-offset-ms", type=float, default=2500, help="initial offset of the simulated clock")
+    parser.add_argument("--sim-drift-ppm", type=float, default=40, help="frequency error of the simulated clock")
+    parser.add_argument("--sim-boot", action="store_true",
+                        help="start the simulated clock at the boot time of the firmware (decades off)")
+    args = parser.parse_args()
+
+    if args.simulate:
+        master, slave = os.openpty()
+        initial_offset_us = BOOT_US - now_us() if args.sim_boot else int(args.sim_offset_ms * 1000)
+        simulate(master, initial_offset_us, args.sim_drift_ppm)
+        port = os.ttyname(slave)
+    elif args.port:
+        port = args.port
+    else:
+        parser.error("a serial port or --simulate is required")
+
+    fd = open_serial(port, args.baud)
+    reader = LineReader(fd)
+    offsets = []
+    print("round  offset_us  delay_us  jitter_us  samples")
+    round_ = 0
+    while not args.rounds or round_ < args.rounds:
+        round_ += 1
+        samples = [s for s in (sample(fd, reader, 1.0) for _ in range(args.samples)) if s]
+        if not samples:
+            print("%5d  no reply" % round_, file=sys.stderr)
+            time.sleep(args.interval)
+            continue
+        offset, delay = min(samples, key=lambda s: s[1])
+        offsets.append(offset)
+        recent = offsets[-9:]  # Jitter: RMS of the differences between successive offsets, as in NTP
+        jitter = math.sqrt(statistics.fmean((b - a) ** 2 for a, b in zip(recent, recent[1:]))) if len(recent) > 1 else 0.0
+        print("%5d  %9.0f  %8.0f  %9.0f  %7d" % (round_, offset, delay, jitter, len(samples)), flush=True)
+        if not args.dry_run and abs(offset) >= delay / 2:  # Below half the delay, the offset isn't significant
+            os.write(fd, b"ADJ %d\n" % round(-offset))
+            if abs(offset) >= STEP_US:
+                offsets = []  # The clock steps: restart the jitter estimate
+        time.sleep(args.interval)
+
+
+if __name__ == "__main__":
+    main()